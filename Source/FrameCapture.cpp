@@ -0,0 +1,300 @@
+#include "FrameCapture.h"
+#include <cstring>
+
+namespace {
+	unsigned char clampByte(int value) {
+		return (unsigned char)(value < 0 ? 0 : value > 255 ? 255 : value);
+	}
+
+	// Checks that pattern holds exactly one integer conversion such as %d or %05u and no
+	// other % than %%, so it is safe to hand to snprintf. The conversion is turned into
+	// %u to match the unsigned frame index.
+	bool makeFramePattern(std::string& pattern) {
+		int conversions = 0;
+		for (size_t i = 0; i < pattern.size(); i++) {
+			if (pattern[i] != '%') continue;
+			if (++i < pattern.size() && pattern[i] == '%') continue;
+			while (i < pattern.size() && std::strchr("-+ #0", pattern[i])) i++;
+			while (i < pattern.size() && pattern[i] >= '0' && pattern[i] <= '9') i++;
+			if (i == pattern.size() || !std::strchr("diu", pattern[i])) return false;
+			pattern[i] = 'u';
+			conversions++;
+		}
+		return conversions == 1;
+	}
+}
+
+FrameCapture::FrameCapture()
+	: format(PPM_SEQUENCE), stream(NULL), width(0), height(0), rate(60), oldestSlot(0), pendingSlots(0),
+	  captured(0), dropped(0), lossless(false), stopping(false), written(0), writeFailed(false) {
+}
+
+FrameCapture::~FrameCapture() {
+	// Without a context the buffers can't be read any more, only the writer is stopped
+	stopWriter();
+}
+
+bool FrameCapture::start(const char* outputPath, int frameWidth, int frameHeight, int frameRate) {
+	finish();
+	errorText.clear();
+	if (!glFenceSync || !glMapBufferRange) {
+		errorText = "No fence sync support";
+		return false;
+	}
+
+	path = outputPath;
+	size_t length = path.size();
+	if (path == "-" || (length > 4 && path.compare(length - 4, 4, ".y4m") == 0)) {
+		format = Y4M_STREAM;
+		// 4:2:0 chroma needs even dimensions
+		frameWidth &= ~1;
+		frameHeight &= ~1;
+	} else if (makeFramePattern(path)) {
+		format = PPM_SEQUENCE;
+	} else {
+		errorText = "Expected a .y4m file, - or an image pattern with one %d such as frame%05d.ppm";
+		return false;
+	}
+	if (frameWidth <= 0 || frameHeight <= 0) {
+		errorText = "Empty frame";
+		return false;
+	}
+	width = frameWidth;
+	height = frameHeight;
+	rate = frameRate > 0 ? frameRate : 60;
+
+	if (format == Y4M_STREAM) {
+		stream = path == "-" ? stdout : std::fopen(path.c_str(), "wb");
+		if (!stream) {
+			errorText = "Failed to open " + path;
+			return false;
+		}
+		std::fprintf(stream, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg\n", width, height, rate);
+	}
+
+	const size_t frameSize = (size_t)width * height * 4;
+	slots.resize(SLOT_COUNT);
+	for (int i = 0; i < SLOT_COUNT; i++) {
+		glGenBuffers(1, &slots[i].buffer);
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, slots[i].buffer);
+		glBufferData(GL_PIXEL_PACK_BUFFER, frameSize, NULL, GL_STREAM_READ);
+		slots[i].fence = NULL;
+	}
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	oldestSlot = 0;
+	pendingSlots = 0;
+	captured = 0;
+	dropped = 0;
+
+	written = 0;
+	writeFailed = false;
+	stopping = false;
+	freeFrames.clear();
+	ready.clear();
+	for (int i = 0; i < FRAME_COUNT; i++) {
+		frames[i].pixels.resize(frameSize);
+		freeFrames.push_back(&frames[i]);
+	}
+	thread = std::thread(&FrameCapture::run, this);
+	return true;
+}
+
+void FrameCapture::capture() {
+	if (!active()) return;
+	// Hand on whatever has finished; only a full ring waits for the GPU
+	collect(false);
+	if (pendingSlots == SLOT_COUNT) collect(true);
+
+	Slot& slot = slots[(oldestSlot + pendingSlots) % SLOT_COUNT];
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+	glPixelStorei(GL_PACK_ALIGNMENT, 4);
+	// Into the buffer object, so this returns without waiting for the frame
+	glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	pendingSlots++;
+}
+
+// Maps the readbacks whose fences have passed, oldest first, and queues them for the
+// writer. Returns whether any were collected.
+bool FrameCapture::collect(bool waitForOldest) {
+	bool collected = false;
+	while (pendingSlots > 0) {
+		Slot& slot = slots[oldestSlot];
+		GLuint64 timeout = waitForOldest && !collected ? 1000000000ULL : 0;
+		// The flush makes sure the fence reaches the GPU at all
+		GLenum status = glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, timeout);
+		if (status == GL_TIMEOUT_EXPIRED) {
+			if (timeout == 0) break;
+		}
+		glDeleteSync(slot.fence);
+		slot.fence = NULL;
+		oldestSlot = (oldestSlot + 1) % SLOT_COUNT;
+		pendingSlots--;
+		collected = true;
+		if (status == GL_WAIT_FAILED || status == GL_TIMEOUT_EXPIRED) {
+			dropped++;
+			continue;
+		}
+
+		Frame* frame = NULL;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			if (lossless) {
+				while (freeFrames.empty()) wake.wait(lock);
+			}
+			if (!freeFrames.empty()) {
+				frame = freeFrames.back();
+				freeFrames.pop_back();
+			}
+		}
+		if (!frame) {
+			// The writer is behind
+			dropped++;
+			continue;
+		}
+
+		const size_t frameSize = frame->pixels.size();
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+		const void* pixels = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, frameSize, GL_MAP_READ_BIT);
+		bool mapped = pixels != NULL;
+		if (mapped) {
+			memcpy(&frame->pixels[0], pixels, frameSize);
+			glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+		}
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if (mapped) {
+				frame->index = captured++;
+				ready.push_back(frame);
+			} else {
+				freeFrames.push_back(frame);
+				dropped++;
+			}
+		}
+		if (mapped) wake.notify_one();
+	}
+	return collected;
+}
+
+void FrameCapture::finish() {
+	if (!active()) return;
+	// Nothing is dropped here, the writer is waited for instead
+	bool dropWhenBehind = !lossless;
+	lossless = true;
+	while (pendingSlots > 0) collect(true);
+	lossless = !dropWhenBehind;
+	for (size_t i = 0; i < slots.size(); i++) {
+		if (slots[i].fence) glDeleteSync(slots[i].fence);
+		glDeleteBuffers(1, &slots[i].buffer);
+	}
+	slots.clear();
+	pendingSlots = 0;
+	stopWriter();
+}
+
+void FrameCapture::stopWriter() {
+	if (thread.joinable()) {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopping = true;
+		}
+		wake.notify_all();
+		thread.join();
+	}
+	if (stream) {
+		if (stream != stdout) std::fclose(stream);
+		else std::fflush(stream);
+		stream = NULL;
+	}
+}
+
+void FrameCapture::run() {
+	std::vector<unsigned char> scratch;
+	std::unique_lock<std::mutex> lock(mutex);
+	for (;;) {
+		while (ready.empty() && !stopping) wake.wait(lock);
+		if (ready.empty()) break;
+		Frame* frame = ready.front();
+		ready.pop_front();
+		lock.unlock();
+
+		// After a failed write the rest are only released
+		if (!writeFailed) {
+			if (writeFrame(*frame, scratch)) {
+				written++;
+			} else {
+				writeFailed = true;
+			}
+		}
+
+		lock.lock();
+		freeFrames.push_back(frame);
+		// finish() may be waiting for a free frame
+		wake.notify_all();
+	}
+}
+
+// Converts to the output format, flipping the rows into top-down order
+bool FrameCapture::writeFrame(const Frame& frame, std::vector<unsigned char>& scratch) {
+	const unsigned char* rgba = &frame.pixels[0];
+	const size_t rowSize = (size_t)width * 4;
+
+	if (format == PPM_SEQUENCE) {
+		char name[1024];
+		snprintf(name, sizeof(name), path.c_str(), frame.index);
+		std::FILE* file = std::fopen(name, "wb");
+		if (!file) {
+			errorText = std::string("Failed to open ") + name;
+			return false;
+		}
+		scratch.resize((size_t)width * height * 3);
+		unsigned char* out = &scratch[0];
+		for (int y = height - 1; y >= 0; y--) {
+			const unsigned char* in = rgba + y * rowSize;
+			for (int x = 0; x < width; x++, in += 4, out += 3) {
+				out[0] = in[0];
+				out[1] = in[1];
+				out[2] = in[2];
+			}
+		}
+		std::fprintf(file, "P6\n%d %d\n255\n", width, height);
+		bool ok = std::fwrite(&scratch[0], 1, scratch.size(), file) == scratch.size();
+		if (std::fclose(file) != 0) ok = false;
+		if (!ok) errorText = std::string("Failed to write ") + name;
+		return ok;
+	}
+
+	// Full range BT.601 (C420jpeg), chroma averaged over 2x2 blocks
+	const size_t lumaSize = (size_t)width * height;
+	const size_t chromaSize = lumaSize / 4;
+	scratch.resize(lumaSize + 2 * chromaSize);
+	unsigned char* lumaPlane = &scratch[0];
+	unsigned char* uPlane = lumaPlane + lumaSize;
+	unsigned char* vPlane = uPlane + chromaSize;
+	for (int y = 0; y < height; y += 2) {
+		// Top-down output rows y and y + 1
+		const unsigned char* rows[2] = { rgba + (height - 1 - y) * rowSize, rgba + (height - 2 - y) * rowSize };
+		for (int x = 0; x < width; x += 2) {
+			int sumR = 0, sumG = 0, sumB = 0;
+			for (int dy = 0; dy < 2; dy++) {
+				for (int dx = 0; dx < 2; dx++) {
+					const unsigned char* p = rows[dy] + (x + dx) * 4;
+					int r = p[0], g = p[1], b = p[2];
+					lumaPlane[(y + dy) * width + x + dx] = (unsigned char)((77 * r + 150 * g + 29 * b + 128) >> 8);
+					sumR += r;
+					sumG += g;
+					sumB += b;
+				}
+			}
+			size_t c = (y / 2) * (width / 2) + x / 2;
+			uPlane[c] = clampByte(((-43 * sumR - 85 * sumG + 128 * sumB + 512) >> 10) + 128);
+			vPlane[c] = clampByte(((128 * sumR - 107 * sumG - 21 * sumB + 512) >> 10) + 128);
+		}
+	}
+	bool ok = std::fputs("FRAME\n", stream) >= 0 && std::fwrite(&scratch[0], 1, scratch.size(), stream) == scratch.size();
+	if (!ok) errorText = "Failed to write " + path;
+	return ok;
+}
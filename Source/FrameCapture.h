@@ -0,0 +1,85 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Records rendered frames without stalling the GL thread (--capture).
+// capture() starts an asynchronous glReadPixels into one of a ring of pixel buffer
+// objects and fences it; the pixels are only mapped once the fence has passed, a
+// frame or two later. A writer thread converts and writes them, either as numbered
+// PPM images (a path with a %d pattern) or as one raw YUV4MPEG2 stream (a .y4m path,
+// or "-" for stdout, e.g. piped into ffmpeg).
+// Frames keep the size capture was started with. When the writer falls behind,
+// frames are dropped rather than slowing the game down, unless capture is lossless.
+class FrameCapture {
+public:
+	FrameCapture();
+	~FrameCapture();
+
+	// Needs a current context with fences (GL 3.2 or ARB_sync)
+	bool start(const char* path, int width, int height, int frameRate);
+	// Waits for the writer instead of dropping frames, for offline rendering
+	void setLossless(bool enabled) { lossless = enabled; }
+	// Reads back the frame just rendered, before it is presented
+	void capture();
+	// Writes out every frame captured so far and releases the buffers, while the
+	// context still exists
+	void finish();
+
+	bool active() const { return !slots.empty(); }
+	// Why start() failed, or why frames stopped being written
+	const std::string& error() const { return errorText; }
+	unsigned int capturedCount() const { return captured; }
+	unsigned int droppedCount() const { return dropped; }
+	unsigned int writtenCount() const { return written.load(); }
+
+private:
+	enum Format { PPM_SEQUENCE, Y4M_STREAM };
+
+	struct Slot {
+		GLuint buffer;
+		GLsync fence;
+	};
+
+	struct Frame {
+		std::vector<unsigned char> pixels; // RGBA, bottom row first
+		unsigned int index;
+	};
+
+	static const int SLOT_COUNT = 3;  // Frames in flight on the GPU
+	static const int FRAME_COUNT = 4; // Frames queued for the writer
+
+	bool collect(bool waitForOldest);
+	void run();
+	bool writeFrame(const Frame& frame, std::vector<unsigned char>& scratch);
+	void stopWriter();
+
+	Format format;
+	std::string path;
+	std::FILE* stream;
+	int width, height, rate;
+	std::vector<Slot> slots;
+	int oldestSlot;   // Ring position of the oldest readback in flight
+	int pendingSlots; // Readbacks in flight
+	unsigned int captured, dropped;
+	bool lossless;
+	std::string errorText;
+
+	// Shared with the writer thread
+	std::thread thread;
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::deque<Frame*> ready;     // Oldest first
+	std::vector<Frame*> freeFrames;
+	Frame frames[FRAME_COUNT];
+	bool stopping;
+	std::atomic<unsigned int> written;
+	std::atomic<bool> writeFailed;
+};
@@ -0,0 +1,45 @@
+#include "FrameLimiter.h"
+#include <thread>
+
+FrameLimiter::FrameLimiter() : rate(0.0), period(Clock::duration::zero()), sleepOvershoot(std::chrono::milliseconds(1)) {
+}
+
+void FrameLimiter::setTargetRate(double framesPerSecond) {
+	rate = framesPerSecond > 0.0 ? framesPerSecond : 0.0;
+	period = rate > 0.0 ? std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / rate)) : Clock::duration::zero();
+	deadline = Clock::now() + period;
+}
+
+void FrameLimiter::wait() {
+	if (period == Clock::duration::zero()) return;
+
+	Clock::time_point now = Clock::now();
+	// After a hitch, start over instead of rushing through frames to catch up
+	if (now - deadline > period) {
+		deadline = now;
+	}
+
+	// Coarse sleep, stopping early by the expected overshoot
+	Clock::duration remaining = deadline - now;
+	if (remaining > sleepOvershoot) {
+		Clock::duration request = remaining - sleepOvershoot;
+		std::this_thread::sleep_for(request);
+		Clock::time_point woke = Clock::now();
+		Clock::duration overshoot = (woke - now) - request;
+		// Follow increases quickly and decreases slowly
+		if (overshoot > sleepOvershoot) {
+			sleepOvershoot = (sleepOvershoot + overshoot) / 2;
+		} else {
+			sleepOvershoot = (sleepOvershoot * 15 + overshoot) / 16;
+		}
+		if (sleepOvershoot < std::chrono::microseconds(50)) {
+			sleepOvershoot = std::chrono::microseconds(50);
+		}
+	}
+
+	// Fine wait for the rest
+	while (Clock::now() < deadline) {
+		std::this_thread::yield();
+	}
+	deadline += period;
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <chrono>
+
+// Caps the frame rate by sleeping until the next frame deadline.
+// The OS sleep is only trusted up to its measured overshoot; the last stretch
+// before the deadline is spent yielding, which keeps the error well under a millisecond.
+class FrameLimiter {
+public:
+	FrameLimiter();
+
+	// Frames per second to hold, 0 to disable the limiter
+	void setTargetRate(double framesPerSecond);
+	double targetRate() const { return rate; }
+
+	// Call once per frame after presenting it
+	void wait();
+
+private:
+	typedef std::chrono::steady_clock Clock;
+
+	double rate;
+	Clock::duration period;
+	Clock::time_point deadline;
+	Clock::duration sleepOvershoot; // Running estimate of how late sleep_for wakes up
+};
@@ -0,0 +1,53 @@
+#include "FrameProfiler.h"
+
+FrameProfiler::FrameProfiler() : phaseStart(0), inFrame(false), windowTime(0), windowFrames(0), averageWindow(500000000ULL) {
+	for (int i = 0; i < PHASE_COUNT; i++) {
+		current[i] = total[i] = 0;
+		last[i] = average[i] = 0.0f;
+	}
+}
+
+void FrameProfiler::beginFrame(unsigned long long now) {
+	if (inFrame) finishFrame();
+	inFrame = true;
+	phaseStart = now;
+}
+
+void FrameProfiler::endPhase(Phase phase, unsigned long long now) {
+	if (!inFrame) return;
+	// The same phase may be ended twice in a frame, the times add up
+	current[phase] += now - phaseStart;
+	phaseStart = now;
+}
+
+void FrameProfiler::finishFrame() {
+	unsigned long long frameTime = 0;
+	for (int i = 0; i < PHASE_COUNT; i++) {
+		last[i] = (float)(current[i] / 1e6);
+		total[i] += current[i];
+		frameTime += current[i];
+		current[i] = 0;
+	}
+	windowTime += frameTime;
+	windowFrames++;
+
+	if (windowTime >= averageWindow) {
+		for (int i = 0; i < PHASE_COUNT; i++) {
+			average[i] = (float)(total[i] / 1e6 / windowFrames);
+			total[i] = 0;
+		}
+		windowTime = 0;
+		windowFrames = 0;
+	}
+}
+
+const char* FrameProfiler::phaseName(Phase phase) {
+	switch (phase) {
+		case EVENTS: return "Events";
+		case SIMULATE: return "Simulate";
+		case RENDER: return "Render";
+		case PRESENT: return "Present";
+		case SLEEP: return "Sleep";
+		default: return "?";
+	}
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+// Wall time spent in each phase of the game loop.
+// The loop marks the end of every phase; the time since the previous mark is
+// charged to it. Averages cover a window of frames so the overlay stays readable.
+class FrameProfiler {
+public:
+	enum Phase { EVENTS, SIMULATE, RENDER, PRESENT, SLEEP, PHASE_COUNT };
+
+	FrameProfiler();
+
+	// Times are glutGetElapsedTimeNs nanoseconds
+	void beginFrame(unsigned long long now);
+	void endPhase(Phase phase, unsigned long long now);
+	// Averages are refreshed once this much time has been recorded
+	void setAverageWindow(unsigned long long nanoseconds) { averageWindow = nanoseconds; }
+
+	// The last complete frame, in milliseconds
+	float lastMs(Phase phase) const { return last[phase]; }
+	// Average per frame over the last finished window, in milliseconds
+	float averageMs(Phase phase) const { return average[phase]; }
+	static const char* phaseName(Phase phase);
+
+private:
+	void finishFrame();
+
+	unsigned long long phaseStart;
+	bool inFrame;
+	unsigned long long current[PHASE_COUNT]; // Frame being recorded
+	unsigned long long total[PHASE_COUNT];   // Frames of the current window
+	unsigned long long windowTime;
+	int windowFrames;
+	unsigned long long averageWindow;
+	float last[PHASE_COUNT];
+	float average[PHASE_COUNT];
+};
@@ -0,0 +1,114 @@
+#include "GLDebugOutput.h"
+#include <cstring>
+
+// KHR_debug tokens, not part of the GL 4.1 loader
+#define GL_CONTEXT_FLAG_DEBUG_BIT 0x00000002
+#define GL_DEBUG_OUTPUT 0x92E0
+#define GL_DEBUG_SOURCE_API 0x8246
+#define GL_DEBUG_SOURCE_WINDOW_SYSTEM 0x8247
+#define GL_DEBUG_SOURCE_SHADER_COMPILER 0x8248
+#define GL_DEBUG_SOURCE_THIRD_PARTY 0x8249
+#define GL_DEBUG_SOURCE_APPLICATION 0x824A
+#define GL_DEBUG_TYPE_ERROR 0x824C
+#define GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR 0x824D
+#define GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR 0x824E
+#define GL_DEBUG_TYPE_PORTABILITY 0x824F
+#define GL_DEBUG_TYPE_PERFORMANCE 0x8250
+#define GL_DEBUG_SEVERITY_HIGH 0x9146
+#define GL_DEBUG_SEVERITY_MEDIUM 0x9147
+#define GL_DEBUG_SEVERITY_LOW 0x9148
+#define GL_DEBUG_SEVERITY_NOTIFICATION 0x826B
+
+namespace {
+	bool hasExtension(const char* name) {
+		if (GLVersion.major >= 3) {
+			GLint count = 0;
+			glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+			for (GLint i = 0; i < count; i++) {
+				const char* extension = (const char*)glGetStringi(GL_EXTENSIONS, i);
+				if (extension && strcmp(extension, name) == 0) return true;
+			}
+			return false;
+		}
+		const char* extensions = (const char*)glGetString(GL_EXTENSIONS);
+		size_t length = strlen(name);
+		for (const char* p = extensions; p && (p = strstr(p, name)) != NULL; p += length) {
+			if ((p == extensions || p[-1] == ' ') && (p[length] == ' ' || p[length] == '\0')) return true;
+		}
+		return false;
+	}
+
+	const char* sourceName(GLenum source) {
+		switch (source) {
+			case GL_DEBUG_SOURCE_API: return "API";
+			case GL_DEBUG_SOURCE_WINDOW_SYSTEM: return "window system";
+			case GL_DEBUG_SOURCE_SHADER_COMPILER: return "shader compiler";
+			case GL_DEBUG_SOURCE_THIRD_PARTY: return "third party";
+			case GL_DEBUG_SOURCE_APPLICATION: return "application";
+			default: return "other";
+		}
+	}
+
+	const char* typeName(GLenum type) {
+		switch (type) {
+			case GL_DEBUG_TYPE_ERROR: return "error";
+			case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR: return "deprecated";
+			case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR: return "undefined behavior";
+			case GL_DEBUG_TYPE_PORTABILITY: return "portability";
+			case GL_DEBUG_TYPE_PERFORMANCE: return "performance";
+			default: return "other";
+		}
+	}
+
+	const char* severityName(GLenum severity) {
+		switch (severity) {
+			case GL_DEBUG_SEVERITY_HIGH: return "high";
+			case GL_DEBUG_SEVERITY_MEDIUM: return "medium";
+			case GL_DEBUG_SEVERITY_LOW: return "low";
+			default: return "notification";
+		}
+	}
+}
+
+GLDebugOutput::GLDebugOutput(Logger& logger)
+	: logger(logger), limit(20, 1000000000ULL), debugMessageCallback(NULL) {
+}
+
+bool GLDebugOutput::init(GLADloadproc load) {
+	// Only a debug context reports anything worth the callback
+	if (GLVersion.major < 3) return false;
+	GLint flags = 0;
+	glGetIntegerv(GL_CONTEXT_FLAGS, &flags);
+	if (!(flags & GL_CONTEXT_FLAG_DEBUG_BIT)) return false;
+	
+	bool core = GLVersion.major > 4 || (GLVersion.major == 4 && GLVersion.minor >= 3);
+	if (core || hasExtension("GL_KHR_debug")) {
+		debugMessageCallback = (DebugMessageCallbackProc)load("glDebugMessageCallback");
+		if (debugMessageCallback) glEnable(GL_DEBUG_OUTPUT);
+	} else if (hasExtension("GL_ARB_debug_output")) {
+		// Enabled by default in a debug context
+		debugMessageCallback = (DebugMessageCallbackProc)load("glDebugMessageCallbackARB");
+	}
+	if (!debugMessageCallback) return false;
+	
+	// Not GL_DEBUG_OUTPUT_SYNCHRONOUS: that would serialize the driver just like glGetError
+	debugMessageCallback(callback, this);
+	return true;
+}
+
+void GLDebugOutput::shutdown() {
+	if (!debugMessageCallback) return;
+	debugMessageCallback(NULL, NULL);
+	debugMessageCallback = NULL;
+}
+
+void APIENTRY GLDebugOutput::callback(GLenum source, GLenum type, GLuint id, GLenum severity,
+	GLsizei, const GLchar* message, const void* userParam) {
+	// Some drivers send a notification for every buffer placement
+	if (severity == GL_DEBUG_SEVERITY_NOTIFICATION) return;
+	GLDebugOutput* output = (GLDebugOutput*)userParam;
+	LogLevel level = severity == GL_DEBUG_SEVERITY_HIGH ? LOG_ERROR
+		: severity == GL_DEBUG_SEVERITY_MEDIUM ? LOG_WARNING : LOG_INFO;
+	output->logger.limited(output->limit, level, "[GL debug] %s %s from %s (%u): %s",
+		severityName(severity), typeName(type), sourceName(source), id, message);
+}
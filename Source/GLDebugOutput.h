@@ -0,0 +1,30 @@
+#pragma once
+
+#include <glad/glad.h>
+#include "Logger.h"
+
+// Collects OpenGL debug messages (KHR_debug, or ARB_debug_output) without glGetError.
+// The driver may call back from any of its threads while commands execute; the logger
+// only copies the message there and formats it on its own thread. Rate limited, as a
+// bad state change can repeat the same message every draw call.
+class GLDebugOutput {
+public:
+	explicit GLDebugOutput(Logger& logger);
+
+	// Registers the callback if the current context is a debug context that supports it.
+	// The loader is the one given to gladLoadGLLoader.
+	bool init(GLADloadproc load);
+	// Unregisters the callback, while the context still exists
+	void shutdown();
+	bool active() const { return debugMessageCallback != NULL; }
+
+private:
+	typedef void (APIENTRYP DebugMessageCallbackProc)(GLDEBUGPROC callback, const void* userParam);
+
+	static void APIENTRY callback(GLenum source, GLenum type, GLuint id, GLenum severity,
+		GLsizei length, const GLchar* message, const void* userParam);
+
+	Logger& logger;
+	LogRateLimit limit;
+	DebugMessageCallbackProc debugMessageCallback;
+};
@@ -0,0 +1,203 @@
+#include "GamepadInput.h"
+#include <GL/freeglut.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <linux/input.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <time.h>
+#include <unistd.h>
+
+static bool testBit(const unsigned long* bits, int bit) {
+	const int bitsPerLong = 8 * sizeof(unsigned long);
+	return (bits[bit / bitsPerLong] >> (bit % bitsPerLong)) & 1;
+}
+
+static long long monotonicNs() {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+#endif
+
+GamepadInput::GamepadInput(LatestInput& position, Logger& logger) : position(position), logger(logger), fd(-1), wakeFd(-1), lost(false), axisMin(0), axisMax(0), axisFlat(0), clockOffset(0) {
+	name[0] = '\0';
+}
+
+GamepadInput::~GamepadInput() {
+	close();
+}
+
+bool GamepadInput::open(const char* path) {
+#ifdef __linux__
+	close();
+	if (path) {
+		if (!openDevice(path)) return false;
+	} else {
+		char devicePath[32];
+		for (int i = 0; i < 32 && fd < 0; i++) {
+			snprintf(devicePath, sizeof(devicePath), "/dev/input/event%d", i);
+			openDevice(devicePath);
+		}
+		if (fd < 0) return false;
+	}
+
+	wakeFd = eventfd(0, EFD_CLOEXEC);
+	if (wakeFd < 0) {
+		::close(fd);
+		fd = -1;
+		return false;
+	}
+	thread = std::thread(&GamepadInput::run, this);
+	return true;
+#else
+	(void)path;
+	return false;
+#endif
+}
+
+void GamepadInput::close() {
+#ifdef __linux__
+	if (thread.joinable()) {
+		unsigned long long one = 1;
+		if (write(wakeFd, &one, sizeof(one)) != sizeof(one)) {
+			logger.error("[Input]: Can't wake the gamepad thread: %s", strerror(errno));
+		}
+		thread.join();
+	}
+	if (wakeFd >= 0) ::close(wakeFd);
+	if (fd >= 0) ::close(fd);
+	wakeFd = -1;
+	fd = -1;
+	lost = false;
+#endif
+}
+
+#ifdef __linux__
+// Accepts a device with an absolute X axis that reports joystick or gamepad buttons,
+// which leaves out touchpads and tablets.
+bool GamepadInput::openDevice(const char* path) {
+	int device = ::open(path, O_RDONLY | O_CLOEXEC);
+	if (device < 0) return false;
+
+	unsigned long absBits[ABS_CNT / (8 * sizeof(unsigned long)) + 1] = { 0 };
+	unsigned long keyBits[KEY_CNT / (8 * sizeof(unsigned long)) + 1] = { 0 };
+	struct input_absinfo axis;
+	if (ioctl(device, EVIOCGBIT(EV_ABS, sizeof(absBits)), absBits) < 0 ||
+		ioctl(device, EVIOCGBIT(EV_KEY, sizeof(keyBits)), keyBits) < 0 ||
+		!testBit(absBits, ABS_X) ||
+		!(testBit(keyBits, BTN_JOYSTICK) || testBit(keyBits, BTN_GAMEPAD)) ||
+		ioctl(device, EVIOCGABS(ABS_X), &axis) < 0 || axis.maximum <= axis.minimum) {
+		::close(device);
+		return false;
+	}
+
+	if (ioctl(device, EVIOCGNAME(sizeof(name)), name) < 0) {
+		snprintf(name, sizeof(name), "%s", path);
+	}
+	name[sizeof(name) - 1] = '\0';
+	axisMin = axis.minimum;
+	axisMax = axis.maximum;
+	// The dead zone has to leave some travel, normalize divides by what is left
+	int maxFlat = (axisMax - axisMin - 1) / 2;
+	axisFlat = axis.flat < 0 ? 0 : axis.flat > maxFlat ? maxFlat : axis.flat;
+
+	// Event times are CLOCK_REALTIME unless asked otherwise. The freeglut clock is
+	// CLOCK_MONOTONIC based, so the two only differ by the time glutInit was called.
+	int clock = CLOCK_MONOTONIC;
+	if (ioctl(device, EVIOCSCLOCKID, &clock) == 0) {
+		clockOffset = monotonicNs() - (long long)glutGetElapsedTimeNs();
+	} else {
+		struct timespec now;
+		clock_gettime(CLOCK_REALTIME, &now);
+		clockOffset = now.tv_sec * 1000000000LL + now.tv_nsec - (long long)glutGetElapsedTimeNs();
+	}
+
+	fd = device;
+	// Start from wherever the stick is resting now
+	InputEvent event;
+	event.type = InputEvent::AXIS;
+	event.key = 0;
+	event.value = normalize(axis.value);
+	event.time = glutGetElapsedTimeNs();
+	position.set(event);
+	return true;
+}
+
+float GamepadInput::normalize(int value) const {
+	float center = 0.5f * (axisMin + axisMax);
+	float halfRange = 0.5f * (axisMax - axisMin);
+	float offset = value - center;
+	if (offset > -axisFlat && offset < axisFlat) return 0.0f;
+	// Rescale so the stick reaches full speed at the edge and starts from 0 at the dead zone
+	float position = offset > 0.0f ? (offset - axisFlat) / (halfRange - axisFlat) : (offset + axisFlat) / (halfRange - axisFlat);
+	if (position < -1.0f) return -1.0f;
+	if (position > 1.0f) return 1.0f;
+	return position;
+}
+
+void GamepadInput::run() {
+	struct pollfd fds[2];
+	fds[0].fd = fd;
+	fds[0].events = POLLIN;
+	fds[1].fd = wakeFd;
+	fds[1].events = POLLIN;
+
+	struct input_event events[64];
+	int pendingValue = 0;
+	bool pending = false;
+	bool dropped = false;
+	InputEvent event;
+	event.type = InputEvent::AXIS;
+	event.key = 0;
+	for (;;) {
+		int ready = poll(fds, 2, -1);
+		if (ready < 0 && errno == EINTR) continue;
+		if (ready < 0) logger.error("[Input]: Gamepad poll failed: %s", strerror(errno));
+		else if (fds[1].revents) break;
+		if (ready < 0 || (fds[0].revents & (POLLERR | POLLHUP))) {
+			// Unplugged or unreadable, let go of the paddle
+			if (ready >= 0) logger.warning("[Input]: Gamepad \"%s\" disconnected", name);
+			event.value = 0.0f;
+			event.time = glutGetElapsedTimeNs();
+			position.set(event);
+			lost = true;
+			break;
+		}
+
+		ssize_t size = read(fd, events, sizeof(events));
+		if (size <= 0) continue;
+		for (size_t i = 0; i < size / sizeof(events[0]); i++) {
+			const struct input_event& e = events[i];
+			if (e.type == EV_SYN && e.code == SYN_DROPPED) {
+				// The kernel buffer overflowed, skip to the next report and re-read the axis
+				dropped = true;
+			} else if (dropped) {
+				if (e.type == EV_SYN && e.code == SYN_REPORT) {
+					struct input_absinfo axis;
+					dropped = false;
+					if (ioctl(fd, EVIOCGABS(ABS_X), &axis) == 0) {
+						pendingValue = axis.value;
+						pending = true;
+					}
+				}
+			} else if (e.type == EV_ABS && e.code == ABS_X) {
+				pendingValue = e.value;
+				pending = true;
+			}
+			if (!dropped && e.type == EV_SYN && e.code == SYN_REPORT && pending) {
+				// One AXIS event per report, at the time the kernel stamped it
+				event.value = normalize(pendingValue);
+				event.time = (unsigned long long)(e.input_event_sec * 1000000000LL + e.input_event_usec * 1000LL - clockOffset);
+				position.set(event);
+				pending = false;
+			}
+		}
+	}
+}
+#endif
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "InputQueue.h"
+#include "Logger.h"
+#include <atomic>
+#include <thread>
+
+// Reads an analog stick from a Linux evdev device (/dev/input/event*) on its own thread.
+// Each report is published as the latest AXIS event as soon as the kernel delivers it,
+// stamped with the kernel's event time on the glutGetElapsedTimeNs clock. Nothing
+// is polled: the thread sleeps in poll() until the device or close() wakes it. When the
+// device is unplugged the stick is released and the thread stops.
+// On other platforms open() always fails.
+class GamepadInput {
+public:
+	GamepadInput(LatestInput& position, Logger& logger);
+	~GamepadInput();
+
+	// Opens the device at path, or the first joystick or gamepad found if path is null,
+	// and starts reading it. glutInit must have been called.
+	bool open(const char* path);
+	void close();
+
+	// False once the device is gone, until the next open()
+	bool isOpen() const { return fd >= 0 && !lost; }
+	const char* deviceName() const { return name; }
+
+private:
+	bool openDevice(const char* path);
+	void run();
+	float normalize(int value) const;
+
+	LatestInput& position; // Where the stick is
+	Logger& logger;
+	std::thread thread;
+	int fd;
+	int wakeFd; // eventfd that close() signals to stop the thread
+	std::atomic<bool> lost; // Set by the thread when it stops on its own
+	char name[128];
+	int axisMin, axisMax, axisFlat;
+	long long clockOffset; // Kernel event clock minus the glutGetElapsedTimeNs clock, in ns
+};
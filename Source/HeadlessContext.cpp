@@ -0,0 +1,201 @@
+#include "HeadlessContext.h"
+#include <cstdio>
+#include <cstring>
+
+#ifdef HAVE_EGL
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+namespace {
+	bool hasExtension(const char* extensions, const char* name) {
+		size_t length = strlen(name);
+		for (const char* p = extensions; p && (p = strstr(p, name)) != NULL; p += length) {
+			if ((p == extensions || p[-1] == ' ') && (p[length] == ' ' || p[length] == '\0')) return true;
+		}
+		return false;
+	}
+}
+#endif
+
+HeadlessContext::HeadlessContext()
+	: display(NULL), context(NULL), surface(NULL), framebuffer(0), colorBuffer(0), frameWidth(0), frameHeight(0) {
+}
+
+HeadlessContext::~HeadlessContext() {
+	destroy();
+}
+
+#ifdef HAVE_EGL
+bool HeadlessContext::create(int width, int height, bool debug) {
+	destroy();
+	frameWidth = width;
+	frameHeight = height;
+
+	// Mesa's surfaceless platform needs neither a display server nor a GPU (llvmpipe)
+	EGLDisplay eglDisplay = EGL_NO_DISPLAY;
+	const char* platform = "default";
+	const char* clientExtensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+	if (hasExtension(clientExtensions, "EGL_MESA_platform_surfaceless")) {
+		PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+			(PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+		if (getPlatformDisplay) {
+			eglDisplay = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+			platform = "surfaceless";
+		}
+	}
+	EGLint major = 0, minor = 0;
+	if (eglDisplay == EGL_NO_DISPLAY || !eglInitialize(eglDisplay, &major, &minor)) {
+		eglDisplay = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+		platform = "default";
+		if (eglDisplay == EGL_NO_DISPLAY || !eglInitialize(eglDisplay, &major, &minor)) {
+			info = "No EGL display";
+			return false;
+		}
+	}
+	display = eglDisplay;
+	if (!eglBindAPI(EGL_OPENGL_API)) {
+		info = "EGL has no desktop OpenGL";
+		destroy();
+		return false;
+	}
+
+	// Without surfaceless contexts a small pbuffer stands in for the window; the
+	// frame itself is drawn into the framebuffer object either way
+	bool surfaceless = hasExtension(eglQueryString(eglDisplay, EGL_EXTENSIONS), "EGL_KHR_surfaceless_context");
+	const EGLint configAttributes[] = {
+		EGL_SURFACE_TYPE, surfaceless ? 0 : EGL_PBUFFER_BIT,
+		EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+		EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8,
+		EGL_NONE
+	};
+	EGLConfig config = NULL;
+	EGLint configCount = 0;
+	if (!eglChooseConfig(eglDisplay, configAttributes, &config, 1, &configCount) || configCount == 0) {
+		info = "No EGL config for desktop OpenGL";
+		destroy();
+		return false;
+	}
+
+	// Compatibility profile, the same as the window's context
+	const EGLint debugAttributes[] = { EGL_CONTEXT_FLAGS_KHR, EGL_CONTEXT_OPENGL_DEBUG_BIT_KHR, EGL_NONE };
+	EGLContext eglContext = EGL_NO_CONTEXT;
+	if (debug) eglContext = eglCreateContext(eglDisplay, config, EGL_NO_CONTEXT, debugAttributes);
+	if (eglContext == EGL_NO_CONTEXT) eglContext = eglCreateContext(eglDisplay, config, EGL_NO_CONTEXT, NULL);
+	if (eglContext == EGL_NO_CONTEXT) {
+		info = "Failed to create an EGL context";
+		destroy();
+		return false;
+	}
+	context = eglContext;
+
+	EGLSurface eglSurface = EGL_NO_SURFACE;
+	if (!surfaceless) {
+		const EGLint pbufferAttributes[] = { EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE };
+		eglSurface = eglCreatePbufferSurface(eglDisplay, config, pbufferAttributes);
+		if (eglSurface == EGL_NO_SURFACE) {
+			info = "Failed to create an EGL pbuffer";
+			destroy();
+			return false;
+		}
+		surface = eglSurface;
+	}
+	if (!eglMakeCurrent(eglDisplay, eglSurface, eglSurface, eglContext)) {
+		info = "Failed to make the EGL context current";
+		destroy();
+		return false;
+	}
+
+	char buffer[128];
+	snprintf(buffer, sizeof(buffer), "EGL %d.%d, %s platform, %s, %dx%d", major, minor, platform,
+		surfaceless ? "surfaceless" : "pbuffer", width, height);
+	info = buffer;
+	return true;
+}
+
+void HeadlessContext::destroy() {
+	if (!display) return;
+	if (context) {
+		eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context);
+		if (framebuffer) {
+			glBindFramebuffer(GL_FRAMEBUFFER, 0);
+			glDeleteFramebuffers(1, &framebuffer);
+			glDeleteRenderbuffers(1, &colorBuffer);
+			framebuffer = 0;
+			colorBuffer = 0;
+		}
+		eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+		eglDestroyContext(display, context);
+		context = NULL;
+	}
+	if (surface) {
+		eglDestroySurface(display, surface);
+		surface = NULL;
+	}
+	eglTerminate(display);
+	display = NULL;
+}
+
+void* HeadlessContext::getProcAddress(const char* name) {
+	return (void*)eglGetProcAddress(name);
+}
+#else
+bool HeadlessContext::create(int, int, bool) {
+	info = "Built without EGL";
+	return false;
+}
+
+void HeadlessContext::destroy() {
+}
+
+void* HeadlessContext::getProcAddress(const char*) {
+	return NULL;
+}
+#endif
+
+bool HeadlessContext::initFramebuffer() {
+	glGenRenderbuffers(1, &colorBuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, frameWidth, frameHeight);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+	glGenFramebuffers(1, &framebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer);
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		glDeleteFramebuffers(1, &framebuffer);
+		glDeleteRenderbuffers(1, &colorBuffer);
+		framebuffer = 0;
+		colorBuffer = 0;
+		info += ", incomplete framebuffer";
+		return false;
+	}
+	// Code written for a window draws to and reads from the back buffer
+	glDrawBuffer(GL_COLOR_ATTACHMENT0);
+	glReadBuffer(GL_COLOR_ATTACHMENT0);
+	glViewport(0, 0, frameWidth, frameHeight);
+	return true;
+}
+
+void HeadlessContext::present() {
+	glFinish();
+}
+
+bool HeadlessContext::writeImage(const char* path) {
+	if (!framebuffer) return false;
+	pixels.resize(frameWidth * frameHeight * 3);
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	glReadPixels(0, 0, frameWidth, frameHeight, GL_RGB, GL_UNSIGNED_BYTE, &pixels[0]);
+	glPixelStorei(GL_PACK_ALIGNMENT, 4);
+
+	FILE* file = fopen(path, "wb");
+	if (!file) return false;
+	fprintf(file, "P6\n%d %d\n255\n", frameWidth, frameHeight);
+	// GL rows start at the bottom
+	const size_t rowSize = frameWidth * 3;
+	bool written = true;
+	for (int y = frameHeight - 1; y >= 0 && written; y--) {
+		written = fwrite(&pixels[y * rowSize], 1, rowSize, file) == rowSize;
+	}
+	return fclose(file) == 0 && written;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <string>
+#include <vector>
+
+// OpenGL context without a window, for --headless runs on machines with no display
+// (render benchmarks and image comparisons on CI). Created through EGL, on Mesa's
+// surfaceless platform when available and on a pbuffer otherwise. Frames are drawn
+// into a framebuffer object of the requested size, which stays bound as the default
+// render target. Only available when built with EGL (HAVE_EGL).
+class HeadlessContext {
+public:
+	HeadlessContext();
+	~HeadlessContext();
+
+	// Creates the context and makes it current. The GL functions are not loaded yet.
+	bool create(int width, int height, bool debug);
+	// Creates and binds the render target, once the GL functions are loaded
+	bool initFramebuffer();
+	void destroy();
+
+	// For gladLoadGLLoader
+	static void* getProcAddress(const char* name);
+
+	// Waits for the frame to finish, the equivalent of a buffer swap
+	void present();
+	// Writes the render target as a binary PPM image
+	bool writeImage(const char* path);
+
+	int width() const { return frameWidth; }
+	int height() const { return frameHeight; }
+	// How the context was created, or why it could not be
+	const std::string& description() const { return info; }
+
+private:
+	void* display; // EGLDisplay
+	void* context; // EGLContext
+	void* surface; // EGLSurface, none when surfaceless
+	GLuint framebuffer;
+	GLuint colorBuffer;
+	int frameWidth;
+	int frameHeight;
+	std::string info;
+	std::vector<unsigned char> pixels;
+};
@@ -0,0 +1,52 @@
+#include "Hud.h"
+#include <cstdio>
+
+Hud::Hud(TextRenderer& text, float width, float height) : textRenderer(text), refreshInterval(0), lastRefresh(0), sampled(false), rebuilds(0) {
+	const char* formats[FIELD_COUNT] = { "Score: %d", "Lives: %d", "Level: %d" };
+	const float positions[FIELD_COUNT][2] = {
+		{ 10, height - 30 },
+		{ 10, height - 55 },
+		{ width - 100, height - 30 }
+	};
+	for (int i = 0; i < FIELD_COUNT; i++) {
+		fields[i].format = formats[i];
+		fields[i].x = positions[i][0];
+		fields[i].y = positions[i][1];
+		fields[i].value = 0;
+		fields[i].valid = false;
+		fields[i].text[0] = '\0';
+	}
+}
+
+void Hud::update(int score, int lives, int level, int currentTime) {
+	if (sampled && currentTime - lastRefresh < refreshInterval) return;
+	sampled = true;
+	lastRefresh = currentTime;
+
+	setField(fields[SCORE], score);
+	setField(fields[LIVES], lives);
+	setField(fields[LEVEL], level);
+}
+
+void Hud::setField(Field& field, int value) {
+	if (field.valid && field.value == value) return;
+
+	field.value = value;
+	field.valid = true;
+	snprintf(field.text, sizeof(field.text), field.format, value);
+	textRenderer.buildMesh(field.mesh, field.x, field.y, field.text);
+	rebuilds++;
+}
+
+void Hud::draw() {
+	for (int i = 0; i < FIELD_COUNT; i++) {
+		textRenderer.addMesh(fields[i].mesh);
+	}
+}
+
+void Hud::invalidate() {
+	for (int i = 0; i < FIELD_COUNT; i++) {
+		fields[i].valid = false;
+	}
+	sampled = false;
+}
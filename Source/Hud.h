@@ -0,0 +1,48 @@
+#pragma once
+
+#include "TextRenderer.h"
+
+// Score, lives and level readout.
+// Formatted strings and their glyph quads are kept between frames and only rebuilt
+// when a value changes. Values are sampled at most once per refresh interval, so
+// the HUD can update at a lower rate than the game while still being drawn every frame.
+class Hud {
+public:
+	// The layout is given in the same units as the projection, anchored to the top corners.
+	Hud(TextRenderer& text, float width, float height);
+
+	// Minimum time between two samples of the game values, 0 to sample every frame
+	void setRefreshInterval(int milliseconds) { refreshInterval = milliseconds; }
+
+	// Feeds the current values, rebuilding the cached text of the ones that changed.
+	void update(int score, int lives, int level, int currentTime);
+	// Appends the cached text to the text batch.
+	void draw();
+	// Makes the next update sample the values even if the refresh interval has not passed
+	void sampleNextUpdate() { sampled = false; }
+	// Forces every field to be rebuilt on the next update
+	void invalidate();
+
+	int rebuildCount() const { return rebuilds; }
+
+private:
+	struct Field {
+		const char* format;
+		float x, y;
+		int value;
+		bool valid;
+		char text[32];
+		TextRenderer::Mesh mesh;
+	};
+
+	enum { SCORE, LIVES, LEVEL, FIELD_COUNT };
+
+	void setField(Field& field, int value);
+
+	TextRenderer& textRenderer;
+	Field fields[FIELD_COUNT];
+	int refreshInterval;
+	int lastRefresh;
+	bool sampled;
+	int rebuilds;
+};
@@ -0,0 +1,25 @@
+#include "InputQueue.h"
+
+InputQueue::InputQueue() : head(0), tail(0), dropped(0) {
+}
+
+bool InputQueue::push(const InputEvent& event) {
+	size_t t = tail.load(std::memory_order_relaxed);
+	if (t - head.load(std::memory_order_acquire) == CAPACITY) {
+		dropped.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+	events[t & (CAPACITY - 1)] = event;
+	// Publish the event before the new tail
+	tail.store(t + 1, std::memory_order_release);
+	return true;
+}
+
+bool InputQueue::pop(InputEvent& event) {
+	size_t h = head.load(std::memory_order_relaxed);
+	if (h == tail.load(std::memory_order_acquire)) return false;
+	event = events[h & (CAPACITY - 1)];
+	// Hand the slot back to the producer only after it has been read
+	head.store(h + 1, std::memory_order_release);
+	return true;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "TripleBuffer.h"
+#include <atomic>
+#include <cstddef>
+
+// An input event stamped with the time it happened, in glutGetElapsedTimeNs nanoseconds
+struct InputEvent {
+	enum Type { KEY_DOWN, KEY_UP, AXIS, POINTER };
+
+	Type type;
+	unsigned char key; // KEY_DOWN and KEY_UP
+	float value;       // AXIS: stick position from -1 (left) to 1 (right)
+	                   // POINTER: mouse x in game coordinates
+	unsigned long long time;
+};
+
+// Fixed-size single-producer, single-consumer queue of key events.
+// The window system callbacks push, the simulation pops; neither side ever blocks.
+// Absolute positions go through a LatestInput instead and can't fill it.
+// When the simulation falls too far behind, new events are dropped and counted.
+class InputQueue {
+public:
+	InputQueue();
+
+	// Producer side. Returns false if the queue was full.
+	bool push(const InputEvent& event);
+	// Consumer side. Returns false if the queue was empty.
+	bool pop(InputEvent& event);
+
+	unsigned int droppedCount() const { return dropped.load(std::memory_order_relaxed); }
+
+private:
+	static const size_t CAPACITY = 256; // A power of two
+
+	InputEvent events[CAPACITY];
+	std::atomic<size_t> head; // Next slot to pop, only written by the consumer
+	std::atomic<size_t> tail; // Next slot to push, only written by the producer
+	std::atomic<unsigned int> dropped;
+};
+
+// The latest AXIS or POINTER event of an absolute input. Only the newest position
+// matters, so a new one replaces one the simulation hasn't taken yet instead of
+// queueing behind it, and nothing fills up while the simulation is idle.
+class LatestInput {
+public:
+	// Producer side
+	void set(const InputEvent& event) {
+		buffer.writeSlot() = event;
+		buffer.publish();
+	}
+	// Consumer side. Returns false if nothing was set since the last take.
+	bool take(InputEvent& event) {
+		if (!buffer.acquire()) return false;
+		event = buffer.readSlot();
+		return true;
+	}
+
+private:
+	TripleBuffer<InputEvent> buffer;
+};
@@ -0,0 +1,274 @@
+#include "Logger.h"
+#include <chrono>
+#include <cstring>
+
+namespace {
+	// How long the writer sleeps when nobody wakes it
+	const std::chrono::milliseconds WRITER_INTERVAL(50);
+
+	unsigned long long monotonicNs() {
+		return (unsigned long long)std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	const char* levelName(LogLevel level) {
+		switch (level) {
+			case LOG_DEBUG: return "debug";
+			case LOG_INFO: return "info";
+			case LOG_WARNING: return "warning";
+			default: return "error";
+		}
+	}
+}
+
+LogRateLimit::LogRateLimit(unsigned int messages, unsigned long long windowNs)
+	: limit(messages), window(windowNs), windowStart(0), count(0), dropped(0) {
+}
+
+bool LogRateLimit::allow(unsigned long long now, unsigned int& suppressed) {
+	suppressed = 0;
+	unsigned long long start = windowStart.load(std::memory_order_relaxed);
+	if (now - start >= window && windowStart.compare_exchange_strong(start, now, std::memory_order_relaxed)) {
+		// Only the thread that moved the window resets it
+		count.store(0, std::memory_order_relaxed);
+		suppressed = dropped.exchange(0, std::memory_order_relaxed);
+	}
+	if (count.fetch_add(1, std::memory_order_relaxed) < limit) return true;
+	dropped.fetch_add(1, std::memory_order_relaxed);
+	return false;
+}
+
+Logger::Logger() : tail(0), head(0), dropped(0), file(NULL), level(LOG_INFO), startTime(monotonicNs()), stopping(false) {
+	for (size_t i = 0; i < CAPACITY; i++) {
+		slots[i].sequence.store(i, std::memory_order_relaxed);
+	}
+}
+
+Logger::~Logger() {
+	close();
+}
+
+bool Logger::open(const char* path) {
+	close();
+	file = std::fopen(path, "w");
+	if (!file) return false;
+	startTime = monotonicNs();
+	stopping.store(false);
+	thread = std::thread(&Logger::run, this);
+	return true;
+}
+
+void Logger::close() {
+	if (!file) return;
+	{
+		std::lock_guard<std::mutex> lock(wakeMutex);
+		stopping.store(true);
+	}
+	wake.notify_one();
+	thread.join();
+	std::fclose(file);
+	file = NULL;
+}
+
+unsigned long long Logger::now() const {
+	return monotonicNs() - startTime;
+}
+
+void Logger::begin(Record& record, LogLevel messageLevel, const char* format) {
+	record.level = messageLevel;
+	record.time = now();
+	record.format = format;
+	record.argCount = 0;
+	record.stringsUsed = 0;
+}
+
+Logger::Arg* Logger::nextArg(Record& record, Arg::Type type) {
+	const int maxArgs = sizeof(record.args) / sizeof(record.args[0]);
+	if (record.argCount == maxArgs) return NULL;
+	Arg* arg = &record.args[record.argCount++];
+	arg->type = type;
+	return arg;
+}
+
+void Logger::addString(Record& record, const char* value) {
+	Arg* arg = nextArg(record, Arg::STRING);
+	if (!arg) return;
+	if (!value) value = "(null)";
+	// Truncated to the space left, an empty string once it is used up
+	size_t space = sizeof(record.strings) - record.stringsUsed;
+	if (space == 0) {
+		arg->type = Arg::POINTER;
+		arg->p = NULL;
+		return;
+	}
+	size_t length = strlen(value);
+	if (length >= space) length = space - 1;
+	arg->offset = record.stringsUsed;
+	memcpy(record.strings + record.stringsUsed, value, length);
+	record.strings[record.stringsUsed + length] = '\0';
+	record.stringsUsed += length + 1;
+}
+
+void Logger::push(const Record& record) {
+	// Claim a slot. Its sequence equals the position while it is free for that lap.
+	size_t pos = tail.load(std::memory_order_relaxed);
+	Slot* slot;
+	for (;;) {
+		slot = &slots[pos & (CAPACITY - 1)];
+		size_t sequence = slot->sequence.load(std::memory_order_acquire);
+		if (sequence == pos) {
+			if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+		} else if (sequence < pos) {
+			// Still holds a record from the previous lap
+			dropped.fetch_add(1, std::memory_order_relaxed);
+			return;
+		} else {
+			pos = tail.load(std::memory_order_relaxed);
+		}
+	}
+
+	// Only the used part of the string space is copied
+	Record& target = slot->record;
+	size_t fixed = offsetof(Record, strings);
+	memcpy(&target, &record, fixed);
+	memcpy(target.strings, record.strings, record.stringsUsed);
+	// Publish the record before marking the slot filled
+	slot->sequence.store(pos + 1, std::memory_order_release);
+
+	// Errors are written promptly; everything else waits for the writer's next pass
+	// unless the queue is filling up
+	if (record.level >= LOG_ERROR || pos - head.load(std::memory_order_relaxed) >= CAPACITY / 2) {
+		wake.notify_one();
+	}
+}
+
+bool Logger::pop(Record& record) {
+	size_t pos = head.load(std::memory_order_relaxed);
+	Slot& slot = slots[pos & (CAPACITY - 1)];
+	if (slot.sequence.load(std::memory_order_acquire) != pos + 1) return false;
+	size_t fixed = offsetof(Record, strings);
+	memcpy(&record, &slot.record, fixed);
+	memcpy(record.strings, slot.record.strings, slot.record.stringsUsed);
+	// Free the slot for the next lap
+	slot.sequence.store(pos + CAPACITY, std::memory_order_release);
+	head.store(pos + 1, std::memory_order_relaxed);
+	return true;
+}
+
+void Logger::run() {
+	Record record;
+	std::string line;
+	unsigned int reportedDropped = dropped.load();
+	for (;;) {
+		bool stop = stopping.load();
+		bool wrote = false;
+		while (pop(record)) {
+			format(record, line);
+			std::fwrite(line.data(), 1, line.size(), file);
+			wrote = true;
+		}
+		unsigned int lost = dropped.load(std::memory_order_relaxed);
+		if (lost != reportedDropped) {
+			std::fprintf(file, "[%12.6f] warning: %u log messages dropped, the queue was full\n", now() / 1e9, lost - reportedDropped);
+			reportedDropped = lost;
+			wrote = true;
+		}
+		// One flush per batch instead of one per line
+		if (wrote) std::fflush(file);
+		// Records pushed before close() are all written by the pass after it was seen
+		if (stop) break;
+
+		std::unique_lock<std::mutex> lock(wakeMutex);
+		if (!stopping.load()) wake.wait_for(lock, WRITER_INTERVAL);
+	}
+}
+
+// printf-style formatting of a captured record. Each conversion is handed to snprintf
+// on its own, with the length modifier replaced to match how the argument was stored.
+void Logger::format(const Record& record, std::string& out) const {
+	char buffer[512];
+	snprintf(buffer, sizeof(buffer), "[%12.6f] %s: ", record.time / 1e9, levelName(record.level));
+	out = buffer;
+
+	int next = 0;
+	const char* p = record.format;
+	while (*p) {
+		if (*p != '%') {
+			const char* literal = p;
+			while (*p && *p != '%') p++;
+			out.append(literal, p - literal);
+			continue;
+		}
+		if (p[1] == '%') {
+			out += '%';
+			p += 2;
+			continue;
+		}
+
+		// Flags, width and precision are kept; '*' takes its value from the next argument
+		std::string spec = "%";
+		p++;
+		while (*p && strchr("-+ #0", *p)) spec += *p++;
+		for (int part = 0; part < 2; part++) {
+			if (part == 1) {
+				if (*p != '.') break;
+				spec += *p++;
+			}
+			if (*p == '*') {
+				long long value = 0;
+				if (next < record.argCount) {
+					const Arg& arg = record.args[next++];
+					value = arg.type == Arg::UINT ? (long long)arg.u : arg.i;
+				}
+				spec += std::to_string(value);
+				p++;
+			}
+			while (*p >= '0' && *p <= '9') spec += *p++;
+		}
+		while (*p && strchr("hljztLq", *p)) p++;
+		char conversion = *p;
+		if (!conversion) break;
+		p++;
+		if (conversion == 'n') continue;
+
+		if (next >= record.argCount) {
+			out += "<?>";
+			continue;
+		}
+		const Arg& arg = record.args[next++];
+		switch (conversion) {
+			case 'd': case 'i':
+				spec += "ll";
+				spec += conversion;
+				snprintf(buffer, sizeof(buffer), spec.c_str(), arg.type == Arg::UINT ? (long long)arg.u : arg.i);
+				break;
+			case 'o': case 'u': case 'x': case 'X':
+				spec += "ll";
+				spec += conversion;
+				snprintf(buffer, sizeof(buffer), spec.c_str(), arg.type == Arg::INT ? (unsigned long long)arg.i : arg.u);
+				break;
+			case 'c':
+				spec += conversion;
+				snprintf(buffer, sizeof(buffer), spec.c_str(), (int)(arg.type == Arg::UINT ? arg.u : arg.i));
+				break;
+			case 'e': case 'E': case 'f': case 'F': case 'g': case 'G': case 'a': case 'A':
+				spec += conversion;
+				snprintf(buffer, sizeof(buffer), spec.c_str(),
+					arg.type == Arg::DOUBLE ? arg.d : arg.type == Arg::UINT ? (double)arg.u : (double)arg.i);
+				break;
+			case 's':
+				spec += conversion;
+				snprintf(buffer, sizeof(buffer), spec.c_str(), arg.type == Arg::STRING ? record.strings + arg.offset : "(null)");
+				break;
+			case 'p':
+				spec += conversion;
+				snprintf(buffer, sizeof(buffer), spec.c_str(), arg.type == Arg::POINTER ? arg.p : (const void*)NULL);
+				break;
+			default:
+				snprintf(buffer, sizeof(buffer), "<%%%c?>", conversion);
+				break;
+		}
+		out += buffer;
+	}
+	out += '\n';
+}
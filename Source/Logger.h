@@ -0,0 +1,155 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+
+enum LogLevel { LOG_DEBUG, LOG_INFO, LOG_WARNING, LOG_ERROR };
+
+// Lets a burst of messages from one call site through, then drops the rest until
+// the window is over. Safe to share between threads.
+class LogRateLimit {
+public:
+	LogRateLimit(unsigned int messages, unsigned long long windowNs);
+
+	// Whether a message at the given time may pass. On the first message of a new
+	// window, suppressed is set to the number dropped in the previous one.
+	bool allow(unsigned long long now, unsigned int& suppressed);
+
+private:
+	unsigned int limit;
+	unsigned long long window;
+	std::atomic<unsigned long long> windowStart;
+	std::atomic<unsigned int> count;
+	std::atomic<unsigned int> dropped;
+};
+
+// Asynchronous log file writer.
+// write() only copies the format pointer and the arguments into a fixed-size record
+// of a lock-free multi-producer queue, so it can be called from any thread, including
+// driver callbacks. A background thread does the printf-style formatting and the file
+// writes, and flushes when it runs out of records rather than per line.
+// The format must be a string literal; strings passed as arguments are copied.
+class Logger {
+public:
+	Logger();
+	~Logger();
+
+	bool open(const char* path);
+	// Writes out everything queued so far and stops the writer thread
+	void close();
+	bool isOpen() const { return file != NULL; }
+
+	// Messages below the level are dropped without being queued
+	void setLevel(LogLevel minimum) { level = minimum; }
+	// Messages lost because the queue was full
+	unsigned int droppedCount() const { return dropped.load(std::memory_order_relaxed); }
+
+	template<typename... Args>
+	void write(LogLevel messageLevel, const char* format, Args... args) {
+		if (messageLevel < level || !file) return;
+		Record record;
+		begin(record, messageLevel, format);
+		pack(record, args...);
+		push(record);
+	}
+
+	template<typename... Args> void debug(const char* format, Args... args) { write(LOG_DEBUG, format, args...); }
+	template<typename... Args> void info(const char* format, Args... args) { write(LOG_INFO, format, args...); }
+	template<typename... Args> void warning(const char* format, Args... args) { write(LOG_WARNING, format, args...); }
+	template<typename... Args> void error(const char* format, Args... args) { write(LOG_ERROR, format, args...); }
+
+	// write() for call sites that can flood the log
+	template<typename... Args>
+	void limited(LogRateLimit& limit, LogLevel messageLevel, const char* format, Args... args) {
+		if (messageLevel < level || !file) return;
+		unsigned int suppressed = 0;
+		if (!limit.allow(now(), suppressed)) return;
+		if (suppressed) write(messageLevel, "(%u similar messages suppressed)", suppressed);
+		write(messageLevel, format, args...);
+	}
+
+	// Nanoseconds on the monotonic clock since open(), as written in the log
+	unsigned long long now() const;
+
+private:
+	struct Arg {
+		enum Type { INT, UINT, DOUBLE, POINTER, STRING } type;
+		union {
+			long long i;
+			unsigned long long u;
+			double d;
+			const void* p;
+			size_t offset; // Of a STRING in Record::strings
+		};
+	};
+
+	struct Record {
+		LogLevel level;
+		unsigned long long time;
+		const char* format;
+		int argCount;
+		size_t stringsUsed;
+		Arg args[8];
+		char strings[240];
+	};
+
+	struct Slot {
+		std::atomic<size_t> sequence; // Slot position when free, position + 1 when filled
+		Record record;
+	};
+
+	static const size_t CAPACITY = 1024; // A power of two
+
+	void begin(Record& record, LogLevel messageLevel, const char* format);
+	void pack(Record&) {}
+	template<typename T, typename... Rest>
+	void pack(Record& record, T first, Rest... rest) {
+		add(record, first);
+		pack(record, rest...);
+	}
+
+	template<typename T>
+	typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value>::type add(Record& record, T value) {
+		if (Arg* arg = nextArg(record, Arg::INT)) arg->i = value;
+	}
+	template<typename T>
+	typename std::enable_if<std::is_integral<T>::value && !std::is_signed<T>::value>::type add(Record& record, T value) {
+		if (Arg* arg = nextArg(record, Arg::UINT)) arg->u = value;
+	}
+	template<typename T>
+	typename std::enable_if<std::is_enum<T>::value>::type add(Record& record, T value) {
+		if (Arg* arg = nextArg(record, Arg::INT)) arg->i = (long long)value;
+	}
+	void add(Record& record, double value) { if (Arg* arg = nextArg(record, Arg::DOUBLE)) arg->d = value; }
+	void add(Record& record, const char* value) { addString(record, value); }
+	void add(Record& record, char* value) { addString(record, value); }
+	void add(Record& record, const unsigned char* value) { addString(record, (const char*)value); }
+	void add(Record& record, const std::string& value) { addString(record, value.c_str()); }
+	void add(Record& record, const void* value) { if (Arg* arg = nextArg(record, Arg::POINTER)) arg->p = value; }
+
+	Arg* nextArg(Record& record, Arg::Type type);
+	void addString(Record& record, const char* value);
+	void push(const Record& record);
+	bool pop(Record& record);
+	void run();
+	void format(const Record& record, std::string& out) const;
+
+	Slot slots[CAPACITY];
+	std::atomic<size_t> tail; // Next slot to claim, shared by all producers
+	std::atomic<size_t> head; // Next slot to read, only advanced by the writer thread
+	std::atomic<unsigned int> dropped;
+	std::FILE* file;
+	LogLevel level;
+	unsigned long long startTime;
+
+	std::thread thread;
+	std::mutex wakeMutex;
+	std::condition_variable wake;
+	std::atomic<bool> stopping;
+};
@@ -1,9 +1,33 @@
 #include <iostream>
-#include <fstream>
+#include <cstdarg>
+#include <cstdio>
 #include <glad/glad.h>
 #include <GL/freeglut.h>
 #include <vector>
+#include <algorithm>
 #include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <memory>
+#include <thread>
+#include "TextRenderer.h"
+#include "Hud.h"
+#include "Renderer2D.h"
+#include "SoftwareRenderer.h"
+#include "FrameLimiter.h"
+#include "FrameProfiler.h"
+#include "InputQueue.h"
+#include "GamepadInput.h"
+#include "GLDebugOutput.h"
+#include "Logger.h"
+#include "HeadlessContext.h"
+#include "FrameCapture.h"
+#include "ResolutionScaler.h"
+#include "RenderCommandBuffer.h"
+#include "TripleBuffer.h"
 
 // Game constants
 const int WINDOW_WIDTH = 800;
@@ -15,15 +39,29 @@ const float BRICK_WIDTH = 75.0f;
 const float BRICK_HEIGHT = 25.0f;
 const int BRICK_ROWS = 8;
 const int BRICK_COLS = 10;
+const int BRICK_MASK_WORDS = (BRICK_ROWS * BRICK_COLS + 31) / 32; // One bit per brick, see brickMask
 const float PADDLE_SPEED = 300.0f;
 const float BALL_SPEED = 200.0f;
+const int HUD_REFRESH_INTERVAL = 50; // Milliseconds between HUD value samples
+const double DEFAULT_FRAME_RATE = 60.0; // Used when vertical sync is not available
+const unsigned long long SIM_TICK_NS = 1000000000ULL / 120; // Fixed simulation step
+const int MAX_SIM_TICKS = 8; // Per frame; after a longer stall the backlog is dropped
+const unsigned long long HEADLESS_FRAME_NS = 1000000000ULL / 60; // Simulated time per headless frame
+const int DEFAULT_HEADLESS_FRAMES = 600;
+const unsigned long long FRAME_WAIT_NS = 100000000ULL; // Longest the GL thread waits for a frame it expects
 
-std::ofstream log_file;
+Logger logger;
+GLDebugOutput glDebug(logger);
 
+// glGetError waits for the GPU to catch up. Debug contexts report through glDebug
+// instead, and release builds don't check at all.
 void checkOpenGLError(const char* operation) {
+#ifdef NDEBUG
+    (void)operation;
+#else
+    if (glDebug.active()) return;
     GLenum error = glGetError();
     if (error != GL_NO_ERROR) {
-        log_file << "[OpenGL ERROR] " << operation << ": ";
         const char* errorStr = "";
         switch(error) {
             case GL_INVALID_ENUM: errorStr = "GL_INVALID_ENUM"; break;
@@ -32,8 +70,9 @@ void checkOpenGLError(const char* operation) {
             case GL_OUT_OF_MEMORY: errorStr = "GL_OUT_OF_MEMORY"; break;
             default: errorStr = "Unknown error"; break;
         }
-        log_file << errorStr << " (" << error << ")" << std::endl;
+        logger.error("[OpenGL ERROR] %s: %s (%u)", operation, errorStr, error);
     }
+#endif
 }
 
 
@@ -68,6 +107,10 @@ struct Paddle {
 
 // Game objects
 std::vector<Brick> bricks;
+// How the renderer draws the level's bricks, rebuilt by initBricks and never changed
+// after, and which of them are active: bit i % 32 of word i / 32 for bricks[i]
+std::shared_ptr<const std::vector<RenderBackend::GridCell>> brickCells;
+unsigned int brickMask[BRICK_MASK_WORDS];
 Ball ball(WINDOW_WIDTH / 2, WINDOW_HEIGHT / 2, -BALL_SPEED * 0.7f, -BALL_SPEED * 0.7f);
 Paddle paddle(WINDOW_WIDTH / 2 - PADDLE_WIDTH / 2, 50);
 
@@ -78,50 +121,178 @@ bool gameWon = false;
 bool gameLost = false;
 int score = 0;
 int lives = 3;
+unsigned int gamesStarted = 0; // Counts resets, so the HUD catches up at once
 
-// Input state
+// What a frame shows of the game. The sim thread publishes one after every step and
+// the record thread draws the latest, so neither waits for the other; the globals
+// above belong to the sim thread.
+struct GameSnapshot {
+	unsigned int sequence; // Snapshots published up to this one, 0 before the first
+	unsigned long long time; // Simulation time shown
+	bool animating; // The sim thread keeps stepping
+	unsigned int redrawRequest; // The last redraw request the sim thread saw
+	int simTicks; // Steps taken since the previous snapshot
+	float stepMs; // Average time per step, for the debug overlay
+	std::shared_ptr<const std::vector<RenderBackend::GridCell>> brickCells;
+	unsigned int brickMask[BRICK_MASK_WORDS];
+	Ball ball;
+	Paddle paddle;
+	bool gameRunning, gameWon, gameLost;
+	int score, lives, level;
+	unsigned int gamesStarted;
+	
+	GameSnapshot() : sequence(0), time(0), animating(false), redrawRequest(0), simTicks(0), stepMs(0.0f), ball(0, 0, 0, 0), paddle(0, 0),
+		gameRunning(false), gameWon(false), gameLost(false), score(0), lives(0), level(0), gamesStarted(0) {
+		memset(brickMask, 0, sizeof(brickMask));
+	}
+};
+
+// Input state. Callbacks and the gamepad thread only queue or publish events;
+// keys[] and paddleAxis are the state as of paddleTime.
+InputQueue inputQueue;
+LatestInput gamepadAxis; // Only the latest positions, so they can't back up while idle
+LatestInput pointerPosition;
+GamepadInput gamepad(gamepadAxis, logger);
+std::vector<InputEvent> pendingInput; // Keys, stick and pointer merged in time order, not yet applied
 bool keys[256] = {false};
+float paddleAxis = 0.0f; // Analog stick, -1 to 1
+unsigned long long paddleTime = 0; // Time the paddle has been moved up to
+int windowWidth = WINDOW_WIDTH; // For mapping the mouse into game coordinates
 
-// Time tracking
-int lastTime = 0;
+// Time tracking, in nanoseconds from glutGetElapsedTimeNs
+unsigned long long simTime = 0; // Time the simulation has been stepped up to
+bool animating = false; // Whether the sim thread keeps stepping without a redraw request
 
-void setColor(int colorIndex) {
-	switch(colorIndex) {
-		case 0: glColor3f(1.0f, 0.0f, 0.0f); break; // Red
-		case 1: glColor3f(1.0f, 0.5f, 0.0f); break; // Orange
-		case 2: glColor3f(1.0f, 1.0f, 0.0f); break; // Yellow
-		case 3: glColor3f(0.0f, 1.0f, 0.0f); break; // Green
-		case 4: glColor3f(0.0f, 0.0f, 1.0f); break; // Blue
-		case 5: glColor3f(0.5f, 0.0f, 1.0f); break; // Purple
-		case 6: glColor3f(1.0f, 0.0f, 1.0f); break; // Pink
-		case 7: glColor3f(0.0f, 1.0f, 1.0f); break; // Cyan
-		default: glColor3f(1.0f, 1.0f, 1.0f); break; // White
-	}
-}
+// Threads. The main thread owns the window and its GL context: it pumps freeglut,
+// replays recorded frames and presents them. The sim thread steps the game at a
+// steady rate and publishes snapshots, see runSimThread, and the record thread turns
+// the latest one into the next frame's commands, see runRecordThread.
+TripleBuffer<GameSnapshot> snapshots;
+RenderCommandQueue renderCommands;
+std::thread simThread;
+std::thread recordThread;
+std::mutex threadMutex;
+std::condition_variable simWake; // Redraw requests, visibility and stopping
+std::condition_variable recordWake; // New snapshots and stopping
+bool threadsRunning = false; // Guarded by threadMutex
+std::atomic<unsigned int> redrawRequests(1); // Display callbacks so far; the first frame is due
+std::atomic<unsigned int> snapshotsPublished(0);
+std::atomic<bool> windowVisible(true);
+FrameLimiter tickLimiter; // Paces the sim thread during gameplay
+bool paletteRecorded = false; // The renderer gets the palette with the first frame
+unsigned int hudGame = 0; // gamesStarted as of the last HUD update
+// The brick grid as of the last recorded frame; the renderer keeps it between frames
+std::shared_ptr<const std::vector<RenderBackend::GridCell>> recordedBrickCells;
+unsigned int recordedBrickMask[BRICK_MASK_WORDS];
 
-void drawRect(float x, float y, float width, float height) {
-	glBegin(GL_QUADS);
-	glVertex2f(x, y);
-	glVertex2f(x + width, y);
-	glVertex2f(x + width, y + height);
-	glVertex2f(x, y + height);
-	glEnd();
-}
+// Game loop, see runGameLoop
+bool quitRequested = false;
+bool graphicsReleased = false;
+FrameProfiler profiler; // Main thread; SIMULATE is the wait for the record thread, RENDER the replay
+FrameProfiler simProfiler; // Sim thread
+FrameProfiler recordProfiler; // Record thread; RENDER is the recording
 
-void drawCircle(float x, float y, float radius) {
-	glBegin(GL_TRIANGLE_FAN);
-	glVertex2f(x, y); // Center
-	for (int i = 0; i <= 20; i++) {
-		float angle = 2.0f * 3.14159f * i / 20;
-		glVertex2f(x + cos(angle) * radius, y + sin(angle) * radius);
-	}
-	glEnd();
-}
+// Rendering. renderer is glRenderer, or softwareRenderer with --software.
+Renderer2D glRenderer;
+SoftwareRenderer softwareRenderer;
+RenderBackend* renderer = &glRenderer;
+bool softwareRendering = false;
+TextRenderer textRenderer;
+ResolutionScaler resolutionScaler; // --dynamic-resolution
+Hud hud(textRenderer, WINDOW_WIDTH, WINDOW_HEIGHT);
+std::atomic<bool> showDebugOverlay(false);
+int fpsFrames = 0;
+unsigned long long fpsStartTime = 0;
+float fps = 0.0f;
+float frameMs = 0.0f;
+
+// The GL thread's part of the debug overlay, published after every replay
+struct RenderStatus {
+	float fps, frameMs;
+	RenderBackend::RenderStats stats;
+	float phaseMs[FrameProfiler::PHASE_COUNT];
+	bool scaled;
+	float scale, gpuMs, busyMs, targetMs;
+	int scaledWidth, scaledHeight;
+};
+RenderStatus renderStatus = {};
+std::mutex renderStatusMutex;
+
+// Frame pacing, see --fps and --swap-interval
+FrameLimiter frameLimiter;
+int swapInterval = 1;
+bool swapIntervalApplied = false;
 
+// Offscreen output, see --headless and --capture
+HeadlessContext headlessContext; // Replaces the window
+FrameCapture frameCapture;
+
+// Brick colors by index, followed by the colors used for the paddle and the ball
+const float PALETTE[][3] = {
+	{ 1.0f, 0.0f, 0.0f }, // Red
+	{ 1.0f, 0.5f, 0.0f }, // Orange
+	{ 1.0f, 1.0f, 0.0f }, // Yellow
+	{ 0.0f, 1.0f, 0.0f }, // Green
+	{ 0.0f, 0.0f, 1.0f }, // Blue
+	{ 0.5f, 0.0f, 1.0f }, // Purple
+	{ 1.0f, 0.0f, 1.0f }, // Pink
+	{ 0.0f, 1.0f, 1.0f }, // Cyan
+	{ 1.0f, 1.0f, 1.0f }, // White
+	{ 0.8f, 0.8f, 0.8f }  // Light gray
+};
+const int COLOR_WHITE = 8;
+const int COLOR_PADDLE = 9;
+
+// Queued into the glyph atlas batch, recorded at the end of the frame
 void drawText(float x, float y, const char* text) {
-	glRasterPos2f(x, y);
-	for (const char* c = text; *c != '\0'; c++) {
-		glutBitmapCharacter(GLUT_BITMAP_HELVETICA_18, *c);
+	textRenderer.addText(x, y, text);
+}
+
+void drawDebugOverlay(const GameSnapshot& game) {
+	int activeBricks = 0;
+	int brickCount = game.brickCells ? (int)game.brickCells->size() : 0;
+	for (int i = 0; i < brickCount; i++) {
+		if (game.brickMask[i / 32] & (1u << (i % 32))) activeBricks++;
+	}
+	
+	// As of the last replayed frame, this one is not replayed yet
+	RenderStatus status;
+	{
+		std::lock_guard<std::mutex> lock(renderStatusMutex);
+		status = renderStatus;
+	}
+	const float* phaseMs = status.phaseMs;
+	
+	char lines[13][96];
+	sprintf(lines[0], "FPS: %.1f  Frame: %.3f ms", status.fps, status.frameMs);
+	sprintf(lines[1], "Bricks: %d / %d", activeBricks, brickCount);
+	sprintf(lines[2], "Ball: pos (%.1f, %.1f) vel (%.1f, %.1f)", game.ball.position.x, game.ball.position.y, game.ball.velocity.x, game.ball.velocity.y);
+	sprintf(lines[3], "Paddle: x %.1f  Input events dropped: %u", game.paddle.position.x, inputQueue.droppedCount());
+	sprintf(lines[4], "State: running %d  won %d  lost %d", game.gameRunning, game.gameWon, game.gameLost);
+	sprintf(lines[5], "Score %d  Lives %d  Level %d", game.score, game.lives, game.level);
+	sprintf(lines[6], "Text glyphs queued: %d  HUD rebuilds: %d", (int)textRenderer.pendingGlyphs(), hud.rebuildCount());
+	sprintf(lines[7], "Draw items: %d  Draw calls: %d  State changes: %d", status.stats.items, status.stats.drawCalls, status.stats.stateChanges);
+	sprintf(lines[8], "Swap interval: %d%s  Frame limit: %.0f", swapInterval, swapIntervalApplied ? "" : " (unsupported)", frameLimiter.targetRate());
+	sprintf(lines[9], "GL thread: events %.2f  wait %.2f  replay %.2f  present %.2f  sleep %.2f ms",
+		phaseMs[FrameProfiler::EVENTS], phaseMs[FrameProfiler::SIMULATE], phaseMs[FrameProfiler::RENDER],
+		phaseMs[FrameProfiler::PRESENT], phaseMs[FrameProfiler::SLEEP]);
+	sprintf(lines[10], "Sim thread: step %.3f (%d ticks)  Record thread: record %.2f  wait %.2f ms",
+		game.stepMs, game.simTicks, recordProfiler.averageMs(FrameProfiler::RENDER),
+		recordProfiler.averageMs(FrameProfiler::SLEEP));
+	if (status.scaled) {
+		sprintf(lines[11], "Render scale %.2f (%dx%d)  GPU %.2f  Busy %.2f  Target %.2f ms", status.scale,
+			status.scaledWidth, status.scaledHeight, status.gpuMs, status.busyMs, status.targetMs);
+	} else if (softwareRendering) {
+		snprintf(lines[11], sizeof(lines[11]), "Software renderer: %s", softwareRenderer.surface().description().c_str());
+	} else {
+		sprintf(lines[11], "Render scale: native");
+	}
+	sprintf(lines[12], "F3: toggle this overlay");
+	
+	float y = WINDOW_HEIGHT - 90;
+	for (int i = 0; i < 13; i++) {
+		textRenderer.addText(10, y, lines[i], 1.0f, 1.0f, 0.4f);
+		y -= textRenderer.lineHeight();
 	}
 }
 
@@ -157,6 +328,18 @@ void initBricks() {
 		}
 	}
 	// Add more levels here with else if (currentLevel == N) { ... }
+	
+	// A new layout for the renderer, with every brick active
+	std::vector<RenderBackend::GridCell>* cells = new std::vector<RenderBackend::GridCell>(bricks.size());
+	memset(brickMask, 0, sizeof(brickMask));
+	for (size_t i = 0; i < bricks.size(); i++) {
+		RenderBackend::GridCell& cell = (*cells)[i];
+		cell.x = bricks[i].position.x;
+		cell.y = bricks[i].position.y;
+		cell.color = bricks[i].color;
+		brickMask[i / 32] |= 1u << (i % 32);
+	}
+	brickCells.reset(cells);
 }
 
 void resetBall() {
@@ -164,7 +347,8 @@ void resetBall() {
 	ball.velocity = Vector2(-BALL_SPEED * 0.7f, -BALL_SPEED * 0.7f);
 }
 
-void resetGame() {
+// Called for the input event that starts the game, at its time
+void resetGame(unsigned long long currentTime) {
 	initBricks();
 	resetBall();
 	paddle.position = Vector2(WINDOW_WIDTH / 2 - PADDLE_WIDTH / 2, 50);
@@ -174,26 +358,84 @@ void resetGame() {
 	gameRunning = true;
 	gameWon = false;
 	gameLost = false;
+	gamesStarted++;
+	// Keys held before the game started don't move the paddle
+	paddleTime = currentTime;
 }
 
 bool checkCollision(const Vector2& pos1, float w1, float h1, const Vector2& pos2, float w2, float h2) {
 	return pos1.x < pos2.x + w2 && pos1.x + w1 > pos2.x && pos1.y < pos2.y + h2 && pos1.y + h1 > pos2.y;
 }
 
-void updateGame(float deltaTime) {
+void clampPaddle() {
+	if (paddle.position.x < 0) paddle.position.x = 0;
+	if (paddle.position.x + PADDLE_WIDTH > WINDOW_WIDTH) 
+		paddle.position.x = WINDOW_WIDTH - PADDLE_WIDTH;
+}
+
+// Moves the paddle for the keys and stick held from paddleTime until the given time
+void movePaddle(unsigned long long until) {
+	if (until <= paddleTime) return;
+	float seconds = (float)((until - paddleTime) / 1e9);
+	paddleTime = until;
 	if (!gameRunning) return;
 	
-	// Handle input
-	if (keys['a'] || keys['A']) {
-		paddle.position.x -= PADDLE_SPEED * deltaTime;
-		if (paddle.position.x < 0) paddle.position.x = 0;
-	}
-	if (keys['d'] || keys['D']) {
-		paddle.position.x += PADDLE_SPEED * deltaTime;
-		if (paddle.position.x + PADDLE_WIDTH > WINDOW_WIDTH) 
-			paddle.position.x = WINDOW_WIDTH - PADDLE_WIDTH;
+	float direction = paddleAxis;
+	if (keys['a'] || keys['A']) direction -= 1.0f;
+	if (keys['d'] || keys['D']) direction += 1.0f;
+	if (direction < -1.0f) direction = -1.0f;
+	if (direction > 1.0f) direction = 1.0f;
+	
+	paddle.position.x += PADDLE_SPEED * direction * seconds;
+	clampPaddle();
+}
+
+bool inputEventBefore(const InputEvent& a, const InputEvent& b) {
+	return a.time < b.time;
+}
+
+// Applies the input that happened up to the given time in the order it happened,
+// moving the paddle between events, so a tap shorter than a frame still moves it.
+// Later events stay pending for the tick they belong to.
+void processInputEvents(unsigned long long currentTime) {
+	InputEvent event;
+	while (inputQueue.pop(event)) pendingInput.push_back(event);
+	if (gamepadAxis.take(event)) pendingInput.push_back(event);
+	if (pointerPosition.take(event)) pendingInput.push_back(event);
+	// The keyboard, gamepad and mouse interleave
+	std::stable_sort(pendingInput.begin(), pendingInput.end(), inputEventBefore);
+	
+	size_t applied = 0;
+	for (; applied < pendingInput.size() && pendingInput[applied].time <= currentTime; applied++) {
+		const InputEvent& input = pendingInput[applied];
+		// Events from before the last update can't change the past
+		movePaddle(input.time);
+		if (input.type == InputEvent::AXIS) {
+			paddleAxis = input.value;
+		} else if (input.type == InputEvent::POINTER) {
+			// The mouse places the paddle directly, centred under the pointer
+			if (gameRunning) {
+				paddle.position.x = input.value - PADDLE_WIDTH / 2;
+				clampPaddle();
+			}
+		} else {
+			keys[input.key] = input.type == InputEvent::KEY_DOWN;
+			// Space starts from the menu, R restarts at any time
+			if (input.type == InputEvent::KEY_DOWN && (input.key == 'r' || input.key == 'R' ||
+				(input.key == ' ' && !gameRunning && !gameWon && !gameLost))) {
+				resetGame(input.time);
+			}
+		}
 	}
+	pendingInput.erase(pendingInput.begin(), pendingInput.begin() + applied);
+	movePaddle(currentTime);
+}
+
+void updateGame(float deltaTime, unsigned long long currentTime) {
+	processInputEvents(currentTime);
+	if (!gameRunning) return;
 	
+
 	// Update ball position
 	ball.position = ball.position + ball.velocity * deltaTime;
 	
@@ -226,9 +468,11 @@ void updateGame(float deltaTime) {
 	}
 	
 	// Ball collision with bricks
-	for (auto& brick : bricks) {
+	for (size_t i = 0; i < bricks.size(); i++) {
+		Brick& brick = bricks[i];
 		if (brick.active && checkCollision(ball.position, BALL_SIZE, BALL_SIZE, brick.position, BRICK_WIDTH, BRICK_HEIGHT)) {
 			brick.active = false;
+			brickMask[i / 32] &= ~(1u << (i % 32));
 			ball.velocity.y = -ball.velocity.y;
 			score += 10;
 			break;
@@ -269,130 +513,777 @@ void updateGame(float deltaTime) {
 	}
 }
 
-void display() {
-	// Calculate delta time
-	int currentTime = glutGet(GLUT_ELAPSED_TIME);
-	float deltaTime = (currentTime - lastTime) / 1000.0f;
-	lastTime = currentTime;
-	
-	updateGame(deltaTime);
-	
-	glClearColor(0.0f, 0.0f, 0.1f, 1.0f);
-	glClear(GL_COLOR_BUFFER_BIT);
-	
-	// Set up 2D rendering
-	glMatrixMode(GL_PROJECTION);
-	glLoadIdentity();
-	glOrtho(0, WINDOW_WIDTH, 0, WINDOW_HEIGHT, -1, 1);
-	glMatrixMode(GL_MODELVIEW);
-	glLoadIdentity();
-	
-	if (gameRunning || gameWon || gameLost) {
-		// Draw bricks
-		for (const auto& brick : bricks) {
-			if (brick.active) {
-				setColor(brick.color);
-				drawRect(brick.position.x, brick.position.y, BRICK_WIDTH - 2, BRICK_HEIGHT - 2);
+// Steps the simulation in fixed ticks up to the given time. Returns the number of ticks.
+int simulate(unsigned long long currentTime) {
+	// The time spent waiting on a static screen is not simulated
+	if (!animating || !gameRunning) {
+		updateGame(0.0f, currentTime);
+		simTime = currentTime;
+		return 0;
+	}
+	
+	int ticks = 0;
+	while (gameRunning && currentTime - simTime >= SIM_TICK_NS) {
+		if (ticks == MAX_SIM_TICKS) {
+			simTime = currentTime;
+			break;
+		}
+		simTime += SIM_TICK_NS;
+		updateGame((float)(SIM_TICK_NS / 1e9), simTime);
+		ticks++;
+	}
+	// A game that just ended leaves a static screen, which takes the rest of the input now
+	if (!gameRunning) {
+		updateGame(0.0f, currentTime);
+		simTime = currentTime;
+	}
+	return ticks;
+}
+
+// Frame statistics for the debug overlay
+void countFrame(unsigned long long currentTime) {
+	fpsFrames++;
+	if (currentTime - fpsStartTime >= 500000000ULL) {
+		double interval = (currentTime - fpsStartTime) / 1e9;
+		fps = (float)(fpsFrames / interval);
+		frameMs = (float)(interval * 1000.0 / fpsFrames);
+		fpsFrames = 0;
+		fpsStartTime = currentTime;
+	}
+}
+
+// Records the frame for the GL thread, see replayFrame
+void recordFrame(RenderCommandBuffer& commands, const GameSnapshot& game) {
+	if (!paletteRecorded) {
+		commands.setPalette(PALETTE, sizeof(PALETTE) / sizeof(PALETTE[0]));
+		paletteRecorded = true;
+	}
+	commands.clear();
+	
+	if (game.gameRunning || game.gameWon || game.gameLost) {
+		// Draw bricks. The renderer keeps the grid, so a new level sends the layout and a
+		// destroyed brick the word holding its bit.
+		if (game.brickCells != recordedBrickCells) {
+			recordedBrickCells = game.brickCells;
+			const std::vector<RenderBackend::GridCell>& cells = *recordedBrickCells;
+			commands.setGrid(cells.data(), (int)cells.size(), BRICK_WIDTH - 2, BRICK_HEIGHT - 2);
+			memset(recordedBrickMask, 0, sizeof(recordedBrickMask));
+		}
+		for (int i = 0; i < BRICK_MASK_WORDS; i++) {
+			if (game.brickMask[i] != recordedBrickMask[i]) {
+				commands.setGridVisibility(i, game.brickMask[i]);
+				recordedBrickMask[i] = game.brickMask[i];
 			}
 		}
+		commands.drawGrid();
 		
 		// Draw paddle
-		glColor3f(0.8f, 0.8f, 0.8f);
-		drawRect(paddle.position.x, paddle.position.y, PADDLE_WIDTH, PADDLE_HEIGHT);
+		commands.drawRect(game.paddle.position.x, game.paddle.position.y, PADDLE_WIDTH, PADDLE_HEIGHT, COLOR_PADDLE, RenderBackend::LAYER_ACTORS);
 		
 		// Draw ball
-		glColor3f(1.0f, 1.0f, 1.0f);
-		drawCircle(ball.position.x + BALL_SIZE/2, ball.position.y + BALL_SIZE/2, BALL_SIZE/2);
+		commands.drawCircle(game.ball.position.x + BALL_SIZE/2, game.ball.position.y + BALL_SIZE/2, BALL_SIZE/2, COLOR_WHITE, RenderBackend::LAYER_ACTORS);
 		
-		// Draw UI
-		glColor3f(1.0f, 1.0f, 1.0f);
-		char scoreText[50];
-		sprintf(scoreText, "Score: %d", score);
-		drawText(10, WINDOW_HEIGHT - 30, scoreText);
-		
-		char livesText[50];
-		sprintf(livesText, "Lives: %d", lives);
-		drawText(10, WINDOW_HEIGHT - 55, livesText);
-		
-		char levelText[50]; // For displaying current level
-		sprintf(levelText, "Level: %d", currentLevel);
-		drawText(WINDOW_WIDTH - 100, WINDOW_HEIGHT - 30, levelText);
+		// Draw UI, only reformatted when the values change. Static screens may be the
+		// last frame for a while, so they always show the current values.
+		// A new game shows its values right away.
+		if (game.gamesStarted != hudGame) {
+			hud.invalidate();
+			hudGame = game.gamesStarted;
+		}
+		if (!game.gameRunning) hud.sampleNextUpdate();
+		hud.update(game.score, game.lives, game.level, (int)(game.time / 1000000));
+		hud.draw();
 		
-		if (gameWon) {
+		if (game.gameWon) {
 			drawText(WINDOW_WIDTH/2 - 100, WINDOW_HEIGHT/2, "YOU WIN! Press R to restart");
-		} else if (gameLost) {
+		} else if (game.gameLost) {
 			drawText(WINDOW_WIDTH/2 - 120, WINDOW_HEIGHT/2, "GAME OVER! Press R to restart");
 		}
 	}
 	
 	// Draw instructions
-	if (!gameRunning && !gameWon && !gameLost) {
-		glColor3f(1.0f, 1.0f, 1.0f);
+	if (!game.gameRunning && !game.gameWon && !game.gameLost) {
 		drawText(WINDOW_WIDTH/2 - 150, WINDOW_HEIGHT/2 + 50, "BREAKOUT");
-		drawText(WINDOW_WIDTH/2 - 180, WINDOW_HEIGHT/2, "Use A and D keys to move paddle");
+		drawText(WINDOW_WIDTH/2 - 200, WINDOW_HEIGHT/2, "Use the mouse or A and D keys to move paddle");
 		drawText(WINDOW_WIDTH/2 - 100, WINDOW_HEIGHT/2 - 30, "Press SPACE to start");
 		drawText(WINDOW_WIDTH/2 - 80, WINDOW_HEIGHT/2 - 60, "Press R to restart");
 	}
 	
-	glutSwapBuffers();
-	glutPostRedisplay(); // Continuous rendering
+	if (showDebugOverlay) {
+		drawDebugOverlay(game);
+	}
+	const std::vector<TextRenderer::Vertex>& glyphs = textRenderer.batch();
+	commands.drawText(glyphs.data(), glyphs.size());
+	textRenderer.clear();
 }
 
-void processInput(unsigned char key, int x, int y) {
-	keys[key] = true;
+// Draws a recorded frame through the renderer; the caller presents it
+void replayFrame(const RenderCommandBuffer& commands) {
+	// The projection only changes on reshape, see framebuffer_size_callback, or when
+	// dynamic resolution picks a new scale
+	if (resolutionScaler.active() && resolutionScaler.beginFrame()) {
+		renderer->resize(resolutionScaler.renderWidth(), resolutionScaler.renderHeight());
+	}
+	
+	size_t offset = 0;
+	RenderCommandBuffer::Command command;
+	while (commands.next(offset, command)) {
+		switch (command.type) {
+			case RenderCommandBuffer::SET_PALETTE:
+				renderer->setPalette((const float (*)[3])command.data, command.count);
+				break;
+			case RenderCommandBuffer::CLEAR:
+				renderer->clear();
+				break;
+			case RenderCommandBuffer::DRAW_RECTS: {
+				const RenderCommandBuffer::Rect* rects = (const RenderCommandBuffer::Rect*)command.data;
+				for (int i = 0; i < command.count; i++) {
+					renderer->drawRect(rects[i].x, rects[i].y, rects[i].width, rects[i].height, rects[i].color, command.layer);
+				}
+				break;
+			}
+			case RenderCommandBuffer::DRAW_CIRCLE: {
+				const RenderCommandBuffer::Circle* circle = (const RenderCommandBuffer::Circle*)command.data;
+				renderer->drawCircle(circle->x, circle->y, circle->radius, circle->color, command.layer);
+				break;
+			}
+			case RenderCommandBuffer::DRAW_TEXT:
+				renderer->drawText(textRenderer, (const TextRenderer::Vertex*)command.data, command.count, command.layer);
+				break;
+			case RenderCommandBuffer::SET_GRID: {
+				const RenderCommandBuffer::GridSize* size = (const RenderCommandBuffer::GridSize*)command.data;
+				renderer->setGrid((const RenderBackend::GridCell*)(size + 1), command.count, size->cellWidth, size->cellHeight);
+				break;
+			}
+			case RenderCommandBuffer::SET_GRID_VISIBILITY: {
+				const RenderCommandBuffer::GridWord* words = (const RenderCommandBuffer::GridWord*)command.data;
+				for (int i = 0; i < command.count; i++) {
+					renderer->setGridVisibility(words[i].word, words[i].bits);
+				}
+				break;
+			}
+			case RenderCommandBuffer::DRAW_GRID:
+				renderer->drawGrid(command.layer);
+				break;
+		}
+	}
+	renderer->submit();
+	if (resolutionScaler.active()) resolutionScaler.endFrame();
+}
+
+// Copies what the record thread shows of the GL thread in the debug overlay
+void publishRenderStatus() {
+	std::lock_guard<std::mutex> lock(renderStatusMutex);
+	renderStatus.fps = fps;
+	renderStatus.frameMs = frameMs;
+	renderStatus.stats = renderer->frameStats();
+	for (int i = 0; i < FrameProfiler::PHASE_COUNT; i++) {
+		renderStatus.phaseMs[i] = profiler.averageMs((FrameProfiler::Phase)i);
+	}
+	renderStatus.scaled = resolutionScaler.active();
+	if (renderStatus.scaled) {
+		renderStatus.scale = resolutionScaler.scale();
+		renderStatus.scaledWidth = resolutionScaler.renderWidth();
+		renderStatus.scaledHeight = resolutionScaler.renderHeight();
+		renderStatus.gpuMs = resolutionScaler.gpuMs();
+		renderStatus.busyMs = resolutionScaler.busyMs();
+		renderStatus.targetMs = (float)resolutionScaler.targetFrameMs();
+	}
+}
+
+// Copies the game into the snapshot slot and hands it to the record thread
+void publishSnapshot(unsigned long long currentTime, int ticks, unsigned int redrawRequest) {
+	GameSnapshot& snapshot = snapshots.writeSlot();
+	unsigned int sequence = snapshotsPublished + 1;
+	snapshot.sequence = sequence;
+	snapshot.time = currentTime;
+	snapshot.animating = animating;
+	snapshot.redrawRequest = redrawRequest;
+	snapshot.simTicks = ticks;
+	snapshot.stepMs = simProfiler.averageMs(FrameProfiler::SIMULATE);
+	snapshot.brickCells = brickCells;
+	memcpy(snapshot.brickMask, brickMask, sizeof(brickMask));
+	snapshot.ball = ball;
+	snapshot.paddle = paddle;
+	snapshot.gameRunning = gameRunning;
+	snapshot.gameWon = gameWon;
+	snapshot.gameLost = gameLost;
+	snapshot.score = score;
+	snapshot.lives = lives;
+	snapshot.level = currentLevel;
+	snapshot.gamesStarted = gamesStarted;
+	snapshots.publish();
+	
+	// The record thread only sleeps on static screens; taking the lock orders this
+	// with its check
+	snapshotsPublished = sequence;
+	{
+		std::lock_guard<std::mutex> lock(threadMutex);
+	}
+	recordWake.notify_one();
+}
+
+// The sim thread: steps the game at the tick rate during gameplay, however long
+// frames take to present, and publishes a snapshot after every step. The menu, win
+// and lose screens don't animate; they wait for a redraw request, which input and
+// freeglut's display callback make.
+void runSimThread() {
+	unsigned int seenRequest = 0;
+	auto ready = [&seenRequest] {
+		return !threadsRunning || (windowVisible && (animating || redrawRequests != seenRequest));
+	};
+	while (true) {
+		simProfiler.beginFrame(glutGetElapsedTimeNs());
+		{
+			std::unique_lock<std::mutex> lock(threadMutex);
+			if (!ready()) {
+				// A hidden window or a static screen, the time spent waiting is not simulated
+				animating = false;
+				simWake.wait(lock, ready);
+			}
+			if (!threadsRunning) break;
+		}
+		simProfiler.endPhase(FrameProfiler::SLEEP, glutGetElapsedTimeNs());
+		
+		// Requests arriving from here on get the next snapshot
+		unsigned int request = redrawRequests;
+		unsigned long long currentTime = glutGetElapsedTimeNs();
+		int ticks = simulate(currentTime);
+		animating = gameRunning && windowVisible;
+		publishSnapshot(currentTime, ticks, request);
+		seenRequest = request;
+		simProfiler.endPhase(FrameProfiler::SIMULATE, glutGetElapsedTimeNs());
+		
+		if (animating) tickLimiter.wait();
+		simProfiler.endPhase(FrameProfiler::SLEEP, glutGetElapsedTimeNs());
+	}
+}
+
+// Records the snapshot and tags the frame for the GL thread
+void recordSnapshot(RenderCommandBuffer& commands, const GameSnapshot& game) {
+	recordFrame(commands, game);
+	commands.frameTime = game.time;
+	commands.animating = game.animating;
+	commands.redrawRequest = game.redrawRequest;
+}
+
+// The record thread: turns the latest snapshot into commands whenever the GL thread
+// can take a frame, at most one ahead of it. Snapshots it is too slow for are skipped.
+void runRecordThread() {
+	unsigned int recordedSequence = 0;
+	bool recordedAnimating = false;
+	auto ready = [&recordedSequence, &recordedAnimating] {
+		return !threadsRunning || (windowVisible && (recordedAnimating || snapshotsPublished != recordedSequence));
+	};
+	while (true) {
+		recordProfiler.beginFrame(glutGetElapsedTimeNs());
+		{
+			std::unique_lock<std::mutex> lock(threadMutex);
+			recordWake.wait(lock, ready);
+			if (!threadsRunning) break;
+		}
+		RenderCommandBuffer* commands = renderCommands.beginRecording();
+		if (!commands) break;
+		recordProfiler.endPhase(FrameProfiler::SLEEP, glutGetElapsedTimeNs());
+		
+		snapshots.acquire();
+		const GameSnapshot& game = snapshots.readSlot();
+		recordSnapshot(*commands, game);
+		renderCommands.finishRecording();
+		recordedSequence = game.sequence;
+		recordedAnimating = game.animating;
+		recordProfiler.endPhase(FrameProfiler::RENDER, glutGetElapsedTimeNs());
+	}
+}
+
+// Wakes the sim thread for a frame, from freeglut's callbacks
+void requestRedraw() {
+	{
+		std::lock_guard<std::mutex> lock(threadMutex);
+		redrawRequests++;
+	}
+	simWake.notify_one();
+}
+
+// Before the GL objects go away; the other threads don't touch GL, but the record
+// thread uses the text renderer
+void stopThreads() {
+	{
+		std::lock_guard<std::mutex> lock(threadMutex);
+		threadsRunning = false;
+	}
+	simWake.notify_one();
+	recordWake.notify_one();
+	renderCommands.stop();
+	if (simThread.joinable()) simThread.join();
+	if (recordThread.joinable()) recordThread.join();
+}
+
+// The GL thread's frame: pump freeglut, replay the frame the record thread recorded
+// and present it, then wait for the next frame deadline. This has to be the thread
+// that dispatches freeglut's callbacks, since freeglut makes the window's context
+// current on it before every callback.
+void runGameLoop() {
+	bool frameAnimating = false; // The last replayed frame asked for the next one
+	unsigned int replayedRequest = 0;
+	// A swap that blocks for vsync is waiting, except on software GL where it draws
+	bool swapWaits = swapIntervalApplied && swapInterval > 0 && !resolutionScaler.softwareRasterizer();
+	unsigned long long idleNs = 0; // Spent waiting since the last present, see ResolutionScaler
+	while (!quitRequested) {
+		profiler.beginFrame(glutGetElapsedTimeNs());
+		glutMainLoopEvent();
+		unsigned long long pumped = glutGetElapsedTimeNs();
+		profiler.endPhase(FrameProfiler::EVENTS, pumped);
+		if (quitRequested) break;
+		
+		// A hidden window neither renders nor simulates, the game waits where it was.
+		// Otherwise a frame is on its way after an animated one or a redraw request.
+		bool frameDue = windowVisible && (frameAnimating || redrawRequests != replayedRequest);
+		RenderCommandBuffer* commands = frameDue ? renderCommands.beginReplay(FRAME_WAIT_NS) : NULL;
+		unsigned long long phaseEnd = glutGetElapsedTimeNs();
+		profiler.endPhase(FrameProfiler::SIMULATE, phaseEnd);
+		idleNs += phaseEnd - pumped;
+		
+		if (commands) {
+			countFrame(commands->frameTime);
+			replayFrame(*commands);
+			frameAnimating = commands->animating;
+			replayedRequest = commands->redrawRequest;
+			renderCommands.finishReplay();
+			frameCapture.capture();
+			publishRenderStatus();
+			unsigned long long rendered = glutGetElapsedTimeNs();
+			profiler.endPhase(FrameProfiler::RENDER, rendered);
+			if (softwareRendering) {
+				softwareRenderer.present();
+			} else {
+				glutSwapBuffers();
+			}
+			phaseEnd = glutGetElapsedTimeNs();
+			profiler.endPhase(FrameProfiler::PRESENT, phaseEnd);
+			if (swapWaits) idleNs += phaseEnd - rendered;
+			if (resolutionScaler.active()) resolutionScaler.framePresented(idleNs / 1e6);
+			idleNs = 0;
+		}
+		if (frameAnimating && windowVisible) {
+			// Paced by vsync or the frame limiter. Input arriving meanwhile is
+			// timestamped, so it is applied where it happened by the next ticks.
+			frameLimiter.wait();
+		} else if (!(windowVisible && redrawRequests != replayedRequest)) {
+			glutWaitForEventsNs(~0ULL);
+		}
+		unsigned long long slept = glutGetElapsedTimeNs();
+		profiler.endPhase(FrameProfiler::SLEEP, slept);
+		idleNs += slept - phaseEnd;
+	}
+}
+
+// --headless: renders a fixed number of frames as fast as the GL allows, for
+// benchmarks and image comparisons. The simulation clock starts at zero and
+// advances one 60 Hz frame per frame, so a build renders the same frames on any
+// machine. There is no input, so the game starts right away.
+void runHeadless(int frames, const char* outputPath) {
+	resetGame(0);
+	animating = true;
+	simTime = 0;
+	paddleTime = 0;
+	fpsStartTime = 0;
 	
-	if (key == ' ' && (!gameRunning && !gameWon && !gameLost)) {
-		resetGame();
+	// Every step is recorded and replayed, so there is no sim thread: the record
+	// thread steps the game before each frame and takes the snapshot back at once.
+	// The queue holds it back while the GL thread is a frame behind.
+	unsigned long long simulateNs = 0, recordNs = 0;
+	unsigned long long startTime = glutGetElapsedTimeNs();
+	recordThread = std::thread([frames, &simulateNs, &recordNs] {
+		for (int frame = 1; frame <= frames; frame++) {
+			RenderCommandBuffer* commands = renderCommands.beginRecording();
+			if (!commands) return;
+			unsigned long long currentTime = frame * HEADLESS_FRAME_NS;
+			unsigned long long phaseStart = glutGetElapsedTimeNs();
+			publishSnapshot(currentTime, simulate(currentTime), 0);
+			unsigned long long simulated = glutGetElapsedTimeNs();
+			snapshots.acquire();
+			recordSnapshot(*commands, snapshots.readSlot());
+			renderCommands.finishRecording();
+			simulateNs += simulated - phaseStart;
+			recordNs += glutGetElapsedTimeNs() - simulated;
+		}
+	});
+	
+	unsigned long long waitNs = 0, replayNs = 0, presentNs = 0;
+	for (int frame = 1; frame <= frames; frame++) {
+		unsigned long long phaseStart = glutGetElapsedTimeNs();
+		RenderCommandBuffer* commands = NULL;
+		while (!commands) commands = renderCommands.beginReplay(FRAME_WAIT_NS);
+		unsigned long long received = glutGetElapsedTimeNs();
+		countFrame(commands->frameTime);
+		replayFrame(*commands);
+		renderCommands.finishReplay();
+		frameCapture.capture();
+		unsigned long long replayed = glutGetElapsedTimeNs();
+		if (!softwareRendering) headlessContext.present();
+		unsigned long long presented = glutGetElapsedTimeNs();
+		if (resolutionScaler.active()) resolutionScaler.framePresented((received - phaseStart) / 1e6);
+		waitNs += received - phaseStart;
+		replayNs += replayed - received;
+		presentNs += presented - replayed;
 	}
-	if (key == 'r' || key == 'R') {
-		resetGame();
+	recordThread.join();
+	
+	double seconds = (glutGetElapsedTimeNs() - startTime) / 1e9;
+	double perFrame = frames > 0 ? 1e-6 / frames : 0.0;
+	logger.info("[Headless]: %d frames in %.3f s, %.1f frames/s", frames, seconds, seconds > 0.0 ? frames / seconds : 0.0);
+	logger.info("[Headless]: Per frame on the record thread: simulate %.3f ms, record %.3f ms",
+		simulateNs * perFrame, recordNs * perFrame);
+	logger.info("[Headless]: Per frame on the GL thread: wait %.3f ms, replay %.3f ms, finish %.3f ms",
+		waitNs * perFrame, replayNs * perFrame, presentNs * perFrame);
+	logger.info("[Headless]: Final state: score %d, lives %d, level %d", score, lives, currentLevel);
+	if (resolutionScaler.active()) {
+		logger.info("[Headless]: Final render scale %.2f, GPU %.3f ms, busy %.3f ms", resolutionScaler.scale(),
+			resolutionScaler.gpuMs(), resolutionScaler.busyMs());
 	}
+	if (outputPath) {
+		bool written = softwareRendering ? softwareRenderer.writeImage(outputPath) : headlessContext.writeImage(outputPath);
+		if (written) {
+			logger.info("[Headless]: Wrote the last frame to %s", outputPath);
+		} else {
+			logger.error("[Headless]: Failed to write %s", outputPath);
+		}
+	}
+}
+
+// --capture, started once the frame size is known
+void startCapture(const char* path, int width, int height, int frameRate) {
+	if (softwareRendering) {
+		logger.warning("[Capture]: Reads back GL frames, not available with --software");
+		return;
+	}
+	if (frameCapture.start(path, width, height, frameRate)) {
+		logger.info("[Capture]: Recording %dx%d to %s", width, height, path);
+	} else {
+		logger.error("[Capture]: %s", frameCapture.error());
+	}
+}
+
+// --dynamic-resolution, started once the frame size is known
+void startDynamicResolution(int width, int height, double targetMs) {
+	if (softwareRendering) {
+		logger.warning("[Render scale]: Not available with --software");
+		return;
+	}
+	if (!resolutionScaler.init()) {
+		logger.warning("[Render scale]: Needs framebuffer blits (GL 3.0), drawing at native resolution");
+		return;
+	}
+	resolutionScaler.setTargetFrameTime(targetMs);
+	resolutionScaler.resize(width, height);
+	logger.info("[Render scale]: Holding %.2f ms per frame, timed by %s", targetMs,
+		resolutionScaler.hasGpuTimer() ? "GPU timer queries and the time between presents" : "the time between presents");
+}
+
+// freeglut's display callback, for expose, reshape and glutPostRedisplay
+void display() {
+	requestRedraw();
+}
+
+// Deletes the GL objects while the window's context still exists
+void releaseGraphics() {
+	stopThreads();
+	if (graphicsReleased) return;
+	graphicsReleased = true;
+	resolutionScaler.shutdown();
+	if (frameCapture.active()) {
+		frameCapture.finish();
+		logger.info("[Capture]: %u frames written, %u dropped", frameCapture.writtenCount(), frameCapture.droppedCount());
+		if (!frameCapture.error().empty()) logger.error("[Capture]: %s", frameCapture.error());
+	}
+	textRenderer.shutdown();
+	renderer->shutdown();
+	glDebug.shutdown();
+}
+
+// Called with the window's context current, before freeglut destroys it
+void windowClosed() {
+	releaseGraphics();
+	quitRequested = true;
+}
+
+void windowStatusChanged(int state) {
+	windowVisible = state != GLUT_HIDDEN && state != GLUT_FULLY_COVERED;
+	if (windowVisible) requestRedraw();
+}
+
+// Queues a key transition with the time the window system saw it happen
+void queueKeyEvent(InputEvent::Type type, unsigned char key) {
+	InputEvent event;
+	event.type = type;
+	event.key = key;
+	event.value = 0.0f;
+	event.time = glutGetEventTimeNs();
+	inputQueue.push(event);
+}
+
+void processInput(unsigned char key, int x, int y) {
+	// Starting and restarting are up to the sim thread, see processInputEvents
+	queueKeyEvent(InputEvent::KEY_DOWN, key);
 	if (key == 27) { // ESC key
-		exit(0);
+		quitRequested = true;
 	}
+	glutPostRedisplay();
 }
 
 void processInputUp(unsigned char key, int x, int y) {
-	keys[key] = false;
+	queueKeyEvent(InputEvent::KEY_UP, key);
+	glutPostRedisplay();
+}
+
+// freeglut coalesces motion, so this runs at most once per run of queued motion events
+void processMouseMotion(int x, int y) {
+	InputEvent event;
+	event.type = InputEvent::POINTER;
+	event.key = 0;
+	event.value = x * (float)WINDOW_WIDTH / windowWidth;
+	event.time = glutGetEventTimeNs();
+	// No redisplay: the paddle only moves during gameplay, which redraws continuously.
+	// Until then only the latest position is kept, so key events never queue behind it.
+	pointerPosition.set(event);
+}
+
+void processSpecialInput(int key, int x, int y) {
+	if (key == GLUT_KEY_F3) {
+		showDebugOverlay = !showDebugOverlay;
+	}
+	glutPostRedisplay();
 }
 
 void framebuffer_size_callback(int width, int height) {
-	glViewport(0, 0, width, height);
+	windowWidth = width > 0 ? width : 1;
+	renderer->resize(width, height);
+	if (resolutionScaler.active()) resolutionScaler.resize(width, height);
+}
+
+// freeglut's warnings and errors go to the log instead of stderr. The message is
+// formatted here since the va_list does not outlive the call.
+void freeglutWarning(const char* format, va_list args, void* userData) {
+	char message[256];
+	vsnprintf(message, sizeof(message), format, args);
+	((Logger*)userData)->warning("[freeglut]: %s", message);
+}
+
+// freeglut does not expect an error handler to return
+void freeglutError(const char* format, va_list args, void* userData) {
+	char message[256];
+	vsnprintf(message, sizeof(message), format, args);
+	Logger* log = (Logger*)userData;
+	log->error("[freeglut]: %s", message);
+	log->close();
+	if (glutGet(GLUT_INIT_STATE)) glutExit();
+	exit(1);
 }
 
 int main(int argc, char** argv) {
-	log_file = std::ofstream("log.txt");
-	glutInit(&argc, argv);
+	logger.open("log.txt");
+	glutInitWarningFuncUcall(freeglutWarning, &logger);
+	glutInitErrorFuncUcall(freeglutError, &logger);
 	
-	glutInitDisplayMode(GLUT_DOUBLE | GLUT_RGB);
-	glutInitWindowSize(WINDOW_WIDTH, WINDOW_HEIGHT);
-	glutCreateWindow("Breakout Game - FreeGLUT");
+	// Without a display freeglut only provides the fonts and the clock
+	bool headless = false;
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--headless") == 0) headless = true;
+	}
+	if (headless) {
+		glutInitHeadless(&argc, argv);
+	} else {
+		glutInit(&argc, argv);
+	}
 	
-	if (!gladLoadGLLoader((GLADloadproc)glutGetProcAddress)) {
-		log_file << "[GLAD]: Failed to load OpenGL methods from driver." << std::endl;
-		log_file.close();
+	// Game options, after glutInit has removed its own
+	double frameRate = -1.0; // Negative means only when vsync is unavailable
+	const char* inputDevice = NULL; // NULL finds the first gamepad
+	int headlessFrames = DEFAULT_HEADLESS_FRAMES;
+	const char* outputPath = NULL; // Last headless frame, as a PPM image
+	const char* capturePath = NULL; // Every frame, see FrameCapture
+	bool dynamicResolution = false;
+	double targetFrameMs = 0.0; // 0 is the frame rate's interval
+#ifdef NDEBUG
+	bool debugContext = false;
+#else
+	bool debugContext = true;
+#endif
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--gl-debug") == 0) {
+			debugContext = true;
+		} else if (strcmp(argv[i], "--dynamic-resolution") == 0) {
+			dynamicResolution = true;
+		} else if (strcmp(argv[i], "--software") == 0) {
+			softwareRendering = true;
+		} else if (i + 1 == argc) {
+			break;
+		} else if (strcmp(argv[i], "--fps") == 0) {
+			frameRate = atof(argv[++i]);
+		} else if (strcmp(argv[i], "--swap-interval") == 0) {
+			swapInterval = atoi(argv[++i]);
+		} else if (strcmp(argv[i], "--input-device") == 0) {
+			inputDevice = argv[++i];
+		} else if (strcmp(argv[i], "--frames") == 0) {
+			headlessFrames = atoi(argv[++i]);
+		} else if (strcmp(argv[i], "--output") == 0) {
+			outputPath = argv[++i];
+		} else if (strcmp(argv[i], "--capture") == 0) {
+			capturePath = argv[++i];
+		} else if (strcmp(argv[i], "--target-frame-ms") == 0) {
+			targetFrameMs = atof(argv[++i]);
+		}
+	}
+	
+	// Debug builds and --gl-debug ask for a debug context, which reports errors through glDebug
+	GLADloadproc loadProc = (GLADloadproc)glutGetProcAddress;
+	if (headless) {
+		if (!headlessContext.create(WINDOW_WIDTH, WINDOW_HEIGHT, debugContext)) {
+			logger.error("[Headless]: %s", headlessContext.description());
+			logger.close();
+			return -1;
+		}
+		loadProc = (GLADloadproc)HeadlessContext::getProcAddress;
+	} else {
+		if (debugContext) glutInitContextFlags(GLUT_DEBUG);
+		glutInitDisplayMode(GLUT_DOUBLE | GLUT_RGB);
+		glutInitWindowSize(WINDOW_WIDTH, WINDOW_HEIGHT);
+		glutCreateWindow("Breakout Game - FreeGLUT");
+	}
+	
+	if (!gladLoadGLLoader(loadProc)) {
+		logger.error("[GLAD]: Failed to load OpenGL methods from driver.");
+		logger.close();
 		return -1;
 	}
 	
-	log_file << "OpenGL Successfully Initialized" << std::endl;
-	log_file << "OpenGL Vendor: " << glGetString(GL_VENDOR) << std::endl;
-	log_file << "OpenGL Renderer: " << glGetString(GL_RENDERER) << std::endl;
-	log_file << "OpenGL Version: " << glGetString(GL_VERSION) << std::endl;
+	logger.info("OpenGL Successfully Initialized");
+	logger.info("OpenGL Vendor: %s", glGetString(GL_VENDOR));
+	logger.info("OpenGL Renderer: %s", glGetString(GL_RENDERER));
+	logger.info("OpenGL Version: %s", glGetString(GL_VERSION));
+	if (headless) {
+		bool framebufferReady = headlessContext.initFramebuffer();
+		logger.info("[Headless]: %s", headlessContext.description());
+		if (!framebufferReady) {
+			logger.close();
+			return -1;
+		}
+	}
+	if (glDebug.init(loadProc)) {
+		logger.info("[GL debug]: Debug output enabled");
+	} else if (debugContext) {
+		logger.warning("[GL debug]: No debug output, falling back to glGetError");
+	}
+	
+	if (!textRenderer.init(GLUT_BITMAP_HELVETICA_18)) {
+		logger.error("[Text]: Failed to build the glyph atlas.");
+		logger.close();
+		return -1;
+	}
+	
+	// GL still builds the glyph atlas and owns the window, the software renderer
+	// only takes over drawing and presenting
+	if (softwareRendering) {
+		if (softwareRenderer.init(WINDOW_WIDTH, WINDOW_HEIGHT, !headless)) {
+			renderer = &softwareRenderer;
+			logger.info("[Renderer]: Software rasterizer, %s", headless ? "in memory" : softwareRenderer.surface().description().c_str());
+		} else {
+			logger.warning("[Renderer]: No software rendering (%s), using OpenGL", softwareRenderer.surface().description());
+			softwareRendering = false;
+		}
+	}
+	if (!softwareRendering) {
+		glRenderer.init(WINDOW_WIDTH, WINDOW_HEIGHT);
+		if (glRenderer.usingShaders()) {
+			logger.info("[Renderer]: Using the shader pipeline.");
+		} else {
+			logger.warning("[Renderer]: Using fixed-function fallback: %s", glRenderer.fallbackReason());
+		}
+	}
+	renderer->setClearColor(0.0f, 0.0f, 0.1f);
+	
+	if (headless) {
+		// Nothing to pace or to take input from
+		framebuffer_size_callback(WINDOW_WIDTH, WINDOW_HEIGHT);
+		initBricks();
+		hud.setRefreshInterval(HUD_REFRESH_INTERVAL);
+		if (dynamicResolution) {
+			startDynamicResolution(WINDOW_WIDTH, WINDOW_HEIGHT, targetFrameMs > 0.0 ? targetFrameMs : HEADLESS_FRAME_NS / 1e6);
+		}
+		// Offline, so every frame is kept however long writing them takes
+		frameCapture.setLossless(true);
+		if (capturePath) startCapture(capturePath, WINDOW_WIDTH, WINDOW_HEIGHT, 1000000000ULL / HEADLESS_FRAME_NS);
+		checkOpenGLError("Before headless frames");
+		runHeadless(headlessFrames, outputPath);
+		releaseGraphics();
+		headlessContext.destroy();
+		glutExit();
+		logger.close();
+		return 0;
+	}
+	
+	swapIntervalApplied = glutSwapInterval(swapInterval) != 0;
+	if (frameRate < 0.0) {
+		// Software frames are not synchronized to the display
+		frameRate = swapIntervalApplied && swapInterval > 0 && !softwareRendering ? 0.0 : DEFAULT_FRAME_RATE;
+	}
+	frameLimiter.setTargetRate(frameRate);
+	logger.info("[Frame pacing]: Swap interval %d%s, frame limit %g", swapInterval,
+		swapIntervalApplied ? "" : " (unsupported)", frameRate);
+	if (dynamicResolution) {
+		double frameInterval = 1000.0 / (frameRate > 0.0 ? frameRate : DEFAULT_FRAME_RATE);
+		startDynamicResolution(glutGet(GLUT_WINDOW_WIDTH), glutGet(GLUT_WINDOW_HEIGHT),
+			targetFrameMs > 0.0 ? targetFrameMs : frameInterval);
+	}
+	// Frames are recorded as they are rendered; the video's nominal rate is
+	// the frame limit, or a typical refresh rate under vsync
+	if (capturePath) {
+		startCapture(capturePath, glutGet(GLUT_WINDOW_WIDTH), glutGet(GLUT_WINDOW_HEIGHT),
+			frameRate > 0.0 ? (int)(frameRate + 0.5) : 60);
+	}
+	
+	// "--input-device none" turns the gamepad off
+	if (inputDevice && strcmp(inputDevice, "none") == 0) {
+		logger.info("[Input]: Gamepad disabled");
+	} else if (gamepad.open(inputDevice)) {
+		logger.info("[Input]: Gamepad \"%s\"", gamepad.deviceName());
+	} else {
+		logger.info("[Input]: No gamepad%s%s", inputDevice ? " at " : "", inputDevice ? inputDevice : "");
+	}
 	
 	// Initialize game
 	initBricks();
-	lastTime = glutGet(GLUT_ELAPSED_TIME);
+	simTime = glutGetElapsedTimeNs();
+	fpsStartTime = simTime;
+	hud.setRefreshInterval(HUD_REFRESH_INTERVAL);
 	gameRunning = false; // Start in menu state
 	
 	glutKeyboardFunc(processInput);
 	glutKeyboardUpFunc(processInputUp);
+	glutSpecialFunc(processSpecialInput);
+	glutPassiveMotionFunc(processMouseMotion);
+	glutMotionFunc(processMouseMotion);
+	// A high polling rate mouse queues far more motion than frames; only the latest position matters
+	glutSetOption(GLUT_SKIP_STALE_MOTION_EVENTS, GL_TRUE);
 	glutReshapeFunc(framebuffer_size_callback);
 	glutDisplayFunc(display);
+	glutWindowStatusFunc(windowStatusChanged);
+	glutCloseFunc(windowClosed);
+	// Closing the window ends runGameLoop instead of exiting from inside freeglut
+	glutSetOption(GLUT_ACTION_ON_WINDOW_CLOSE, GLUT_ACTION_CONTINUE_EXECUTION);
+	profiler.setAverageWindow(500000000ULL);
 	
 	checkOpenGLError("Before main loop");
-	glutMainLoop();
-	
+	threadsRunning = true;
+	tickLimiter.setTargetRate(1e9 / SIM_TICK_NS);
+	simThread = std::thread(runSimThread);
+	recordThread = std::thread(runRecordThread);
+	runGameLoop();
 	
-	log_file.close();
+	// Destroys the window if it is still open, which calls windowClosed
+	glutExit();
+	gamepad.close();
+	logger.close();
 	return 0;
 }
\ No newline at end of file
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "TextRenderer.h"
+
+// What the game draws through, so the GL renderer (Renderer2D) and the CPU rasterizer
+// (SoftwareRenderer) are interchangeable. Coordinates are logical units with the origin
+// at the bottom left, scaled to the framebuffer size given to resize. Draws are queued
+// and drawn back to front by layer on submit; presenting is left to the caller.
+class RenderBackend {
+public:
+	static const int PALETTE_SIZE = 16;
+
+	// Drawn back to front
+	enum Layer { LAYER_WORLD, LAYER_ACTORS, LAYER_UI };
+
+	// A cell of the grid, see setGrid
+	struct GridCell {
+		float x, y; // Bottom left
+		int color;
+	};
+
+	struct RenderStats {
+		int items;
+		int drawCalls;
+		int stateChanges; // Program, vertex array, texture, blend and color changes
+	};
+
+	virtual ~RenderBackend() {}
+
+	virtual void shutdown() = 0;
+
+	// Call from the reshape callback with the framebuffer size
+	virtual void resize(int width, int height) = 0;
+	virtual void setPalette(const float colors[][3], int count) = 0;
+	virtual void setClearColor(float r, float g, float b) = 0;
+	// Fills the whole frame with the clear color, right away
+	virtual void clear() = 0;
+
+	virtual void drawRect(float x, float y, float width, float height, int color, int layer = LAYER_WORLD) = 0;
+	virtual void drawCircle(float x, float y, float radius, int color, int layer = LAYER_WORLD) = 0;
+	// Glyph quads built by the text renderer, e.g. its batch. They are read on submit,
+	// so they have to stay untouched until then.
+	virtual void drawText(const TextRenderer& font, const TextRenderer::Vertex* vertices, size_t count, int layer = LAYER_UI) = 0;
+
+	// A grid of same-sized rectangles kept between frames, like the bricks. Which cells
+	// show is a bitmask, bit i % 32 of word i / 32 for cell i, so hiding one changes
+	// one word. setGrid hides every cell.
+	virtual void setGrid(const GridCell* cells, int count, float cellWidth, float cellHeight) = 0;
+	virtual void setGridVisibility(int word, unsigned int bits) = 0;
+	// The visible cells, as of submit
+	virtual void drawGrid(int layer = LAYER_WORLD) = 0;
+	// Sorts and draws everything queued since the last submit
+	virtual void submit() = 0;
+	// Counters of the last submit
+	virtual const RenderStats& frameStats() const = 0;
+};
@@ -0,0 +1,159 @@
+#include "RenderCommandBuffer.h"
+#include <chrono>
+#include <cstring>
+
+namespace {
+	// Headers start on 8 byte boundaries so the data after them is aligned for any field
+	size_t align(size_t offset) {
+		return (offset + 7) & ~(size_t)7;
+	}
+}
+
+RenderCommandBuffer::RenderCommandBuffer()
+	: frameTime(0), animating(false), redrawRequest(0), used(0), lastCommand((size_t)-1) {
+}
+
+void RenderCommandBuffer::reset() {
+	used = 0;
+	lastCommand = (size_t)-1;
+	frameTime = 0;
+	animating = false;
+	redrawRequest = 0;
+}
+
+void* RenderCommandBuffer::grow(size_t size) {
+	if (used + size > memory.size()) {
+		size_t capacity = memory.empty() ? 4096 : memory.size() * 2;
+		while (capacity < used + size) capacity *= 2;
+		memory.resize(capacity);
+	}
+	void* data = &memory[used];
+	used += size;
+	return data;
+}
+
+void* RenderCommandBuffer::append(Type type, int layer, int count, size_t size) {
+	used = align(used);
+	lastCommand = used;
+	Header* header = (Header*)grow(sizeof(Header) + size);
+	header->type = type;
+	header->layer = layer;
+	header->count = count;
+	header->size = (unsigned int)size;
+	return header + 1;
+}
+
+void RenderCommandBuffer::setPalette(const float colors[][3], int count) {
+	memcpy(append(SET_PALETTE, 0, count, count * sizeof(colors[0])), colors, count * sizeof(colors[0]));
+}
+
+void RenderCommandBuffer::clear() {
+	append(CLEAR, 0, 0, 0);
+}
+
+bool RenderCommandBuffer::extend(Type type, int layer, const void* data, size_t size) {
+	if (lastCommand == (size_t)-1) return false;
+	Header* last = (Header*)&memory[lastCommand];
+	if (last->type != type || last->layer != layer || lastCommand + sizeof(Header) + last->size != used) return false;
+	memcpy(grow(size), data, size);
+	// grow may have moved the memory
+	last = (Header*)&memory[lastCommand];
+	last->count++;
+	last->size += (unsigned int)size;
+	return true;
+}
+
+void RenderCommandBuffer::drawRect(float x, float y, float width, float height, int color, int layer) {
+	Rect rect = { x, y, width, height, color };
+	// Joins the previous command when that is a run of rectangles on the same layer
+	if (extend(DRAW_RECTS, layer, &rect, sizeof(Rect))) return;
+	memcpy(append(DRAW_RECTS, layer, 1, sizeof(Rect)), &rect, sizeof(Rect));
+}
+
+void RenderCommandBuffer::drawCircle(float x, float y, float radius, int color, int layer) {
+	Circle circle = { x, y, radius, color };
+	memcpy(append(DRAW_CIRCLE, layer, 1, sizeof(Circle)), &circle, sizeof(Circle));
+}
+
+void RenderCommandBuffer::drawText(const TextRenderer::Vertex* vertices, size_t count, int layer) {
+	if (count == 0) return;
+	memcpy(append(DRAW_TEXT, layer, (int)count, count * sizeof(TextRenderer::Vertex)), vertices, count * sizeof(TextRenderer::Vertex));
+}
+
+void RenderCommandBuffer::setGrid(const RenderBackend::GridCell* cells, int count, float cellWidth, float cellHeight) {
+	GridSize size = { cellWidth, cellHeight };
+	unsigned char* data = (unsigned char*)append(SET_GRID, 0, count, sizeof(GridSize) + count * sizeof(RenderBackend::GridCell));
+	memcpy(data, &size, sizeof(GridSize));
+	if (count > 0) memcpy(data + sizeof(GridSize), cells, count * sizeof(RenderBackend::GridCell));
+}
+
+void RenderCommandBuffer::setGridVisibility(int word, unsigned int bits) {
+	GridWord change = { word, bits };
+	if (extend(SET_GRID_VISIBILITY, 0, &change, sizeof(GridWord))) return;
+	memcpy(append(SET_GRID_VISIBILITY, 0, 1, sizeof(GridWord)), &change, sizeof(GridWord));
+}
+
+void RenderCommandBuffer::drawGrid(int layer) {
+	append(DRAW_GRID, layer, 0, 0);
+}
+
+bool RenderCommandBuffer::next(size_t& offset, Command& command) const {
+	offset = align(offset);
+	if (offset >= used) return false;
+	const Header* header = (const Header*)&memory[offset];
+	command.type = (Type)header->type;
+	command.layer = header->layer;
+	command.count = header->count;
+	command.data = header + 1;
+	offset += sizeof(Header) + header->size;
+	return true;
+}
+
+RenderCommandQueue::RenderCommandQueue() : recording(-1), queued(-1), replaying(-1), stopped(false) {
+}
+
+RenderCommandBuffer* RenderCommandQueue::beginRecording() {
+	std::unique_lock<std::mutex> lock(mutex);
+	// A queued frame is never replaced, so the recorder waits for it to be taken
+	while (!stopped && queued != -1) changed.wait(lock);
+	if (stopped) return NULL;
+	recording = replaying == 0 ? 1 : 0;
+	buffers[recording].reset();
+	return &buffers[recording];
+}
+
+void RenderCommandQueue::finishRecording() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		queued = recording;
+		recording = -1;
+	}
+	changed.notify_all();
+}
+
+RenderCommandBuffer* RenderCommandQueue::beginReplay(unsigned long long timeoutNs) {
+	std::unique_lock<std::mutex> lock(mutex);
+	if (queued == -1 && timeoutNs > 0) {
+		changed.wait_for(lock, std::chrono::nanoseconds(timeoutNs), [this] { return queued != -1; });
+	}
+	if (queued == -1) return NULL;
+	replaying = queued;
+	queued = -1;
+	lock.unlock();
+	// The recorder can start on the other buffer
+	changed.notify_all();
+	return &buffers[replaying];
+}
+
+void RenderCommandQueue::finishReplay() {
+	std::lock_guard<std::mutex> lock(mutex);
+	replaying = -1;
+}
+
+void RenderCommandQueue::stop() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopped = true;
+	}
+	changed.notify_all();
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+#include "RenderBackend.h"
+
+// A frame's drawing, recorded as commands on one thread and replayed through a
+// RenderBackend on the thread that owns the GL context.
+// Commands are packed back to back into one block of memory that is only rewound
+// between frames, a linear allocator, so recording allocates nothing once the block
+// has grown to the size of a frame. Consecutive rectangles of a layer share one command.
+// Grids live in the renderer between frames, so only their changes are recorded.
+class RenderCommandBuffer {
+public:
+	enum Type { SET_PALETTE, CLEAR, DRAW_RECTS, DRAW_CIRCLE, DRAW_TEXT, SET_GRID, SET_GRID_VISIBILITY, DRAW_GRID };
+
+	struct Rect {
+		float x, y, width, height;
+		int color;
+	};
+
+	struct Circle {
+		float x, y, radius;
+		int color;
+	};
+
+	// SET_GRID data, followed by the cells
+	struct GridSize {
+		float cellWidth, cellHeight;
+	};
+
+	struct GridWord {
+		int word;
+		unsigned int bits;
+	};
+
+	// A recorded command as seen by the replay side. data points into the buffer.
+	struct Command {
+		Type type;
+		int layer;
+		int count; // Rects, circles, glyph vertices, palette colors, grid cells or grid words
+		const void* data;
+	};
+
+	RenderCommandBuffer();
+
+	// Rewinds for the next frame, keeping the memory
+	void reset();
+
+	void setPalette(const float colors[][3], int count);
+	void clear();
+	void drawRect(float x, float y, float width, float height, int color, int layer = RenderBackend::LAYER_WORLD);
+	void drawCircle(float x, float y, float radius, int color, int layer = RenderBackend::LAYER_WORLD);
+	// Copies the glyph quads, the text renderer's batch can be cleared afterwards
+	void drawText(const TextRenderer::Vertex* vertices, size_t count, int layer = RenderBackend::LAYER_UI);
+	// See RenderBackend::setGrid. Visibility words of one frame share a command.
+	void setGrid(const RenderBackend::GridCell* cells, int count, float cellWidth, float cellHeight);
+	void setGridVisibility(int word, unsigned int bits);
+	void drawGrid(int layer = RenderBackend::LAYER_WORLD);
+
+	// Walks the commands in recording order: start with offset 0, returns false at the end
+	bool next(size_t& offset, Command& command) const;
+	size_t size() const { return used; }
+
+	// Set by the recording side for the replay side
+	unsigned long long frameTime; // Simulation time the frame shows
+	bool animating;               // More frames follow without a redraw request
+	unsigned int redrawRequest;   // The last redraw request the frame includes
+
+private:
+	struct Header {
+		int type;
+		int layer;
+		int count;
+		unsigned int size; // Bytes of data after the header
+	};
+
+	// Appends a command with room for size bytes of data
+	void* append(Type type, int layer, int count, size_t size);
+	void* grow(size_t size);
+	// Adds an element to the last command if it has the same type and layer
+	bool extend(Type type, int layer, const void* data, size_t size);
+
+	std::vector<unsigned char> memory;
+	size_t used;
+	size_t lastCommand; // Offset of the last header, for extending a run of rectangles or grid words
+};
+
+// Two command buffers passed between a recording thread and a replaying thread.
+// One frame can be recorded while the previous one is replayed; the recorder waits
+// when it gets a full frame ahead, so every recorded frame is replayed, in order.
+class RenderCommandQueue {
+public:
+	RenderCommandQueue();
+
+	// Recording side. Waits for a buffer that is neither queued nor being replayed,
+	// and returns it rewound. Returns NULL once stopped.
+	RenderCommandBuffer* beginRecording();
+	// Queues the buffer from beginRecording for replay
+	void finishRecording();
+
+	// Replay side. Waits up to timeoutNs for a queued buffer, NULL when there is none.
+	RenderCommandBuffer* beginReplay(unsigned long long timeoutNs);
+	// Hands the buffer from beginReplay back for recording
+	void finishReplay();
+
+	// Wakes and refuses the recording side, e.g. before joining its thread
+	void stop();
+
+private:
+	static const int BUFFER_COUNT = 2;
+
+	RenderCommandBuffer buffers[BUFFER_COUNT];
+	int recording; // Indices into buffers, -1 for none
+	int queued;
+	int replaying;
+	bool stopped;
+	std::mutex mutex;
+	std::condition_variable changed;
+};
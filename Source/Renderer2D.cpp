@@ -0,0 +1,643 @@
+#include "Renderer2D.h"
+#include <algorithm>
+#include <cmath>
+
+// Uniform buffer binding points shared by both programs
+const GLuint FRAME_BINDING = 0;
+const GLuint PALETTE_BINDING = 1;
+
+const char* SHAPE_VERTEX_SHADER = R"(
+#version 140
+layout(std140) uniform Frame {
+	mat4 projection;
+	vec4 viewport; // Framebuffer size, then pixels per logical unit
+};
+layout(std140) uniform Palette {
+	vec4 colors[16];
+};
+in vec2 position;
+in float colorIndex;
+out vec4 color;
+void main() {
+	color = colors[int(colorIndex)];
+	gl_Position = projection * vec4(position, 0.0, 1.0);
+}
+)";
+
+const char* SHAPE_FRAGMENT_SHADER = R"(
+#version 140
+in vec4 color;
+out vec4 fragColor;
+void main() {
+	fragColor = color;
+}
+)";
+
+const char* TEXT_VERTEX_SHADER = R"(
+#version 140
+layout(std140) uniform Frame {
+	mat4 projection;
+	vec4 viewport;
+};
+in vec2 position;
+in vec2 texCoord;
+in vec4 vertexColor;
+out vec2 uv;
+out vec4 color;
+void main() {
+	uv = texCoord;
+	color = vertexColor;
+	gl_Position = projection * vec4(position, 0.0, 1.0);
+}
+)";
+
+const char* TEXT_FRAGMENT_SHADER = R"(
+#version 140
+uniform sampler2D atlas;
+in vec2 uv;
+in vec4 color;
+out vec4 fragColor;
+void main() {
+	// Glyphs are either fully on or off, like glBitmap output
+	if (texture(atlas, uv).a < 0.5) discard;
+	fragColor = color;
+}
+)";
+
+// Signed distance field circles, one instanced quad each. The quad is grown by a pixel
+// so the anti-aliased edge is not clipped.
+const char* CIRCLE_VERTEX_SHADER = R"(
+#version 330
+layout(std140) uniform Frame {
+	mat4 projection;
+	vec4 viewport;
+};
+layout(std140) uniform Palette {
+	vec4 colors[16];
+};
+in vec2 corner;
+in vec4 instance; // Center, radius, color index
+out vec2 local;
+out float radius;
+out vec4 color;
+void main() {
+	float extent = instance.z + 1.0 / viewport.z;
+	local = corner * extent;
+	radius = instance.z;
+	color = colors[int(instance.w)];
+	gl_Position = projection * vec4(instance.xy + local, 0.0, 1.0);
+}
+)";
+
+const char* CIRCLE_FRAGMENT_SHADER = R"(
+#version 330
+in vec2 local;
+in float radius;
+in vec4 color;
+out vec4 fragColor;
+void main() {
+	float distance = length(local) - radius;
+	// Coverage of the pixel from the distance gradient, about one pixel wide
+	float coverage = clamp(0.5 - distance / fwidth(distance), 0.0, 1.0);
+	if (coverage <= 0.0) discard;
+	fragColor = vec4(color.rgb, color.a * coverage);
+}
+)";
+
+// Every grid cell is an instance of the circles' quad. Vertex shaders can't discard, so
+// hidden cells are moved outside the clip volume and their triangles are clipped away.
+const char* GRID_VERTEX_SHADER = R"(
+#version 330
+layout(std140) uniform Frame {
+	mat4 projection;
+	vec4 viewport;
+};
+layout(std140) uniform Palette {
+	vec4 colors[16];
+};
+uniform usamplerBuffer visibility;
+uniform vec2 cellSize;
+in vec2 corner;
+in vec3 instance; // Bottom left, color index
+out vec4 color;
+void main() {
+	uint word = texelFetch(visibility, gl_InstanceID >> 5).r;
+	if (((word >> uint(gl_InstanceID & 31)) & 1u) == 0u) {
+		gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+		return;
+	}
+	color = colors[int(instance.z)];
+	gl_Position = projection * vec4(instance.xy + (corner * 0.5 + 0.5) * cellSize, 0.0, 1.0);
+}
+)";
+
+Renderer2D::Renderer2D() :
+	logicalWidth(1.0f), logicalHeight(1.0f), viewportWidth(1), viewportHeight(1),
+	program(0), textProgram(0), frameUniforms(0), paletteUniforms(0),
+	shapeArray(0), shapeBuffer(0), textArray(0), textBuffer(0),
+	circleProgram(0), circleArray(0), quadBuffer(0), instanceBuffer(0),
+	gridProgram(0), gridArray(0), gridCellBuffer(0), gridMaskBuffer(0), gridMaskTexture(0), gridCellSizeLocation(-1),
+	boundMaterial(-1), boundTexture(0), gridCellWidth(0.0f), gridCellHeight(0.0f) {
+	for (int i = 0; i < PALETTE_SIZE; i++) {
+		palette[i][0] = palette[i][1] = palette[i][2] = palette[i][3] = 1.0f;
+	}
+	// Unit circle shared by every circle that is not drawn as a distance field
+	for (int i = 0; i <= CIRCLE_SEGMENTS; i++) {
+		float angle = 2.0f * 3.14159f * i / CIRCLE_SEGMENTS;
+		circleTable[i][0] = std::cos(angle);
+		circleTable[i][1] = std::sin(angle);
+	}
+}
+
+bool Renderer2D::init(float width, float height) {
+	shutdown();
+	logicalWidth = width;
+	logicalHeight = height;
+	viewportWidth = (int)width;
+	viewportHeight = (int)height;
+	errorLog.clear();
+
+	if (!GLAD_GL_VERSION_3_1) {
+		errorLog = "OpenGL 3.1 is not available";
+	} else {
+		program = compileProgram(SHAPE_VERTEX_SHADER, SHAPE_FRAGMENT_SHADER);
+		textProgram = program ? compileProgram(TEXT_VERTEX_SHADER, TEXT_FRAGMENT_SHADER) : 0;
+		if (!textProgram) {
+			shutdown();
+		}
+	}
+
+	if (program) {
+		glUniformBlockBinding(program, glGetUniformBlockIndex(program, "Frame"), FRAME_BINDING);
+		glUniformBlockBinding(program, glGetUniformBlockIndex(program, "Palette"), PALETTE_BINDING);
+		glUniformBlockBinding(textProgram, glGetUniformBlockIndex(textProgram, "Frame"), FRAME_BINDING);
+		glUseProgram(textProgram);
+		glUniform1i(glGetUniformLocation(textProgram, "atlas"), 0);
+		glUseProgram(0);
+
+		glGenBuffers(1, &frameUniforms);
+		glBindBuffer(GL_UNIFORM_BUFFER, frameUniforms);
+		glBufferData(GL_UNIFORM_BUFFER, 20 * sizeof(float), NULL, GL_DYNAMIC_DRAW);
+		glGenBuffers(1, &paletteUniforms);
+		glBindBuffer(GL_UNIFORM_BUFFER, paletteUniforms);
+		glBufferData(GL_UNIFORM_BUFFER, sizeof(palette), palette, GL_STATIC_DRAW);
+		glBindBuffer(GL_UNIFORM_BUFFER, 0);
+		glBindBufferBase(GL_UNIFORM_BUFFER, FRAME_BINDING, frameUniforms);
+		glBindBufferBase(GL_UNIFORM_BUFFER, PALETTE_BINDING, paletteUniforms);
+
+		glGenVertexArrays(1, &shapeArray);
+		glGenBuffers(1, &shapeBuffer);
+		glBindVertexArray(shapeArray);
+		glBindBuffer(GL_ARRAY_BUFFER, shapeBuffer);
+		glEnableVertexAttribArray(0);
+		glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, x));
+		glEnableVertexAttribArray(1);
+		glVertexAttribPointer(1, 1, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, color));
+
+		glGenVertexArrays(1, &textArray);
+		glGenBuffers(1, &textBuffer);
+		glBindVertexArray(textArray);
+		glBindBuffer(GL_ARRAY_BUFFER, textBuffer);
+		glEnableVertexAttribArray(0);
+		glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(TextRenderer::Vertex), (void*)offsetof(TextRenderer::Vertex, x));
+		glEnableVertexAttribArray(1);
+		glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(TextRenderer::Vertex), (void*)offsetof(TextRenderer::Vertex, u));
+		glEnableVertexAttribArray(2);
+		glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(TextRenderer::Vertex), (void*)offsetof(TextRenderer::Vertex, r));
+		glBindVertexArray(0);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+		vertices.reserve(1024);
+	}
+
+	// Instanced circles need attribute divisors; without them circles use the shape batch
+	if (program && GLAD_GL_VERSION_3_3) {
+		circleProgram = compileProgram(CIRCLE_VERTEX_SHADER, CIRCLE_FRAGMENT_SHADER);
+	}
+	if (circleProgram) {
+		glUniformBlockBinding(circleProgram, glGetUniformBlockIndex(circleProgram, "Frame"), FRAME_BINDING);
+		glUniformBlockBinding(circleProgram, glGetUniformBlockIndex(circleProgram, "Palette"), PALETTE_BINDING);
+
+		const float corners[8] = { -1.0f, -1.0f, 1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f };
+		glGenVertexArrays(1, &circleArray);
+		glGenBuffers(1, &quadBuffer);
+		glGenBuffers(1, &instanceBuffer);
+		glBindVertexArray(circleArray);
+		glBindBuffer(GL_ARRAY_BUFFER, quadBuffer);
+		glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+		glEnableVertexAttribArray(0);
+		glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, (void*)0);
+		glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+		glEnableVertexAttribArray(1);
+		glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(CircleInstance), (void*)0);
+		glVertexAttribDivisor(1, 1);
+		glBindVertexArray(0);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		gridProgram = compileProgram(GRID_VERTEX_SHADER, SHAPE_FRAGMENT_SHADER);
+	}
+	if (gridProgram) {
+		glUniformBlockBinding(gridProgram, glGetUniformBlockIndex(gridProgram, "Frame"), FRAME_BINDING);
+		glUniformBlockBinding(gridProgram, glGetUniformBlockIndex(gridProgram, "Palette"), PALETTE_BINDING);
+		gridCellSizeLocation = glGetUniformLocation(gridProgram, "cellSize");
+		glUseProgram(gridProgram);
+		glUniform1i(glGetUniformLocation(gridProgram, "visibility"), 1);
+		glUseProgram(0);
+
+		glGenVertexArrays(1, &gridArray);
+		glGenBuffers(1, &gridCellBuffer);
+		glGenBuffers(1, &gridMaskBuffer);
+		glGenTextures(1, &gridMaskTexture);
+		glBindVertexArray(gridArray);
+		glBindBuffer(GL_ARRAY_BUFFER, quadBuffer);
+		glEnableVertexAttribArray(0);
+		glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, (void*)0);
+		glBindBuffer(GL_ARRAY_BUFFER, gridCellBuffer);
+		glEnableVertexAttribArray(1);
+		glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+		glVertexAttribDivisor(1, 1);
+		glBindVertexArray(0);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		// The words are on texture unit 1, out of the way of the atlas
+		glBindBuffer(GL_TEXTURE_BUFFER, gridMaskBuffer);
+		glBufferData(GL_TEXTURE_BUFFER, sizeof(GLuint), NULL, GL_DYNAMIC_DRAW);
+		glBindBuffer(GL_TEXTURE_BUFFER, 0);
+		glActiveTexture(GL_TEXTURE1);
+		glBindTexture(GL_TEXTURE_BUFFER, gridMaskTexture);
+		glTexBuffer(GL_TEXTURE_BUFFER, GL_R32UI, gridMaskBuffer);
+		glActiveTexture(GL_TEXTURE0);
+	}
+
+	resize(viewportWidth, viewportHeight);
+	return glGetError() == GL_NO_ERROR;
+}
+
+void Renderer2D::shutdown() {
+	GLuint buffers[] = { frameUniforms, paletteUniforms, shapeBuffer, textBuffer, quadBuffer, instanceBuffer, gridCellBuffer, gridMaskBuffer };
+	GLuint arrays[] = { shapeArray, textArray, circleArray, gridArray };
+	if (program) glDeleteProgram(program);
+	if (textProgram) glDeleteProgram(textProgram);
+	if (circleProgram) glDeleteProgram(circleProgram);
+	if (gridProgram) glDeleteProgram(gridProgram);
+	if (frameUniforms || shapeBuffer) glDeleteBuffers(8, buffers);
+	if (shapeArray) glDeleteVertexArrays(4, arrays);
+	if (gridMaskTexture) glDeleteTextures(1, &gridMaskTexture);
+	program = textProgram = circleProgram = gridProgram = 0;
+	frameUniforms = paletteUniforms = shapeBuffer = textBuffer = quadBuffer = instanceBuffer = gridCellBuffer = gridMaskBuffer = 0;
+	shapeArray = textArray = circleArray = gridArray = 0;
+	gridMaskTexture = 0;
+	gridCells.clear();
+	gridMask.clear();
+	boundMaterial = -1;
+	boundTexture = 0;
+	vertices.clear();
+	queue.clear();
+}
+
+GLuint Renderer2D::compileProgram(const char* vertexSource, const char* fragmentSource) {
+	GLuint shaders[2] = { glCreateShader(GL_VERTEX_SHADER), glCreateShader(GL_FRAGMENT_SHADER) };
+	const char* sources[2] = { vertexSource, fragmentSource };
+	GLuint result = glCreateProgram();
+	for (int i = 0; i < 2; i++) {
+		GLint status = GL_FALSE;
+		glShaderSource(shaders[i], 1, &sources[i], NULL);
+		glCompileShader(shaders[i]);
+		glGetShaderiv(shaders[i], GL_COMPILE_STATUS, &status);
+		if (!status) {
+			char info[1024];
+			glGetShaderInfoLog(shaders[i], sizeof(info), NULL, info);
+			errorLog += info;
+		}
+		glAttachShader(result, shaders[i]);
+	}
+
+	// Both programs read the position from attribute 0
+	glBindAttribLocation(result, 0, "position");
+	glBindAttribLocation(result, 0, "corner");
+	glBindAttribLocation(result, 1, "colorIndex");
+	glBindAttribLocation(result, 1, "texCoord");
+	glBindAttribLocation(result, 1, "instance");
+	glBindAttribLocation(result, 2, "vertexColor");
+	glLinkProgram(result);
+	glDeleteShader(shaders[0]);
+	glDeleteShader(shaders[1]);
+
+	GLint status = GL_FALSE;
+	glGetProgramiv(result, GL_LINK_STATUS, &status);
+	if (!status) {
+		char info[1024];
+		glGetProgramInfoLog(result, sizeof(info), NULL, info);
+		errorLog += info;
+		glDeleteProgram(result);
+		return 0;
+	}
+	return result;
+}
+
+void Renderer2D::resize(int width, int height) {
+	viewportWidth = width > 0 ? width : 1;
+	viewportHeight = height > 0 ? height : 1;
+	glViewport(0, 0, viewportWidth, viewportHeight);
+
+	if (program) {
+		writeFrameBlock();
+	} else {
+		// Nothing else touches the matrix stack, so it only needs setting here
+		glMatrixMode(GL_PROJECTION);
+		glLoadIdentity();
+		glOrtho(0, logicalWidth, 0, logicalHeight, -1, 1);
+		glMatrixMode(GL_MODELVIEW);
+		glLoadIdentity();
+	}
+}
+
+void Renderer2D::writeFrameBlock() {
+	// Column-major glOrtho(0, width, 0, height, -1, 1), then the viewport vector
+	float block[20] = { 0 };
+	block[0] = 2.0f / logicalWidth;
+	block[5] = 2.0f / logicalHeight;
+	block[10] = -1.0f;
+	block[12] = -1.0f;
+	block[13] = -1.0f;
+	block[15] = 1.0f;
+	block[16] = (float)viewportWidth;
+	block[17] = (float)viewportHeight;
+	block[18] = viewportWidth / logicalWidth;
+	block[19] = viewportHeight / logicalHeight;
+
+	glBindBuffer(GL_UNIFORM_BUFFER, frameUniforms);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(block), block);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+void Renderer2D::setPalette(const float colors[][3], int count) {
+	for (int i = 0; i < count && i < PALETTE_SIZE; i++) {
+		palette[i][0] = colors[i][0];
+		palette[i][1] = colors[i][1];
+		palette[i][2] = colors[i][2];
+		palette[i][3] = 1.0f;
+	}
+	if (paletteUniforms) {
+		glBindBuffer(GL_UNIFORM_BUFFER, paletteUniforms);
+		glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(palette), palette);
+		glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	}
+}
+
+void Renderer2D::queueItem(int primitive, int layer, int material, int color, float x, float y, float width, float height) {
+	// Layer first so the drawing order is kept, then the state, then submission order
+	DrawItem item;
+	item.key = ((uint64_t)layer << 48) | ((uint64_t)material << 40) | ((uint64_t)color << 32) | (uint32_t)queue.size();
+	item.primitive = primitive;
+	item.material = material;
+	item.color = color;
+	item.x = x;
+	item.y = y;
+	item.width = width;
+	item.height = height;
+	item.font = NULL;
+	item.glyphs = NULL;
+	item.glyphVertices = 0;
+	queue.push_back(item);
+}
+
+void Renderer2D::drawRect(float x, float y, float width, float height, int color, int layer) {
+	queueItem(PRIMITIVE_RECT, layer, MATERIAL_SHAPES, color, x, y, width, height);
+}
+
+void Renderer2D::drawCircle(float x, float y, float radius, int color, int layer) {
+	queueItem(PRIMITIVE_CIRCLE, layer, circleProgram ? MATERIAL_CIRCLES : MATERIAL_SHAPES, color, x, y, radius, radius);
+}
+
+void Renderer2D::drawText(const TextRenderer& font, const TextRenderer::Vertex* vertices, size_t count, int layer) {
+	if (count == 0) return;
+	queueItem(PRIMITIVE_TEXT, layer, MATERIAL_TEXT, 0, 0, 0, 0, 0);
+	queue.back().font = &font;
+	queue.back().glyphs = vertices;
+	queue.back().glyphVertices = count;
+}
+
+void Renderer2D::setGrid(const GridCell* cells, int count, float cellWidth, float cellHeight) {
+	gridCells.assign(cells, cells + count);
+	gridMask.assign((count + 31) / 32, 0);
+	gridCellWidth = cellWidth;
+	gridCellHeight = cellHeight;
+	if (!gridProgram) return;
+
+	// Uploaded once per layout; the color index goes to the shader as a float like the shapes'
+	std::vector<float> instanceData(count * 3);
+	for (int i = 0; i < count; i++) {
+		instanceData[i * 3] = cells[i].x;
+		instanceData[i * 3 + 1] = cells[i].y;
+		instanceData[i * 3 + 2] = (float)cells[i].color;
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, gridCellBuffer);
+	glBufferData(GL_ARRAY_BUFFER, instanceData.size() * sizeof(float), instanceData.empty() ? NULL : &instanceData[0], GL_STATIC_DRAW);
+	glBindBuffer(GL_TEXTURE_BUFFER, gridMaskBuffer);
+	glBufferData(GL_TEXTURE_BUFFER, (gridMask.size() + 1) * sizeof(GLuint), NULL, GL_DYNAMIC_DRAW);
+	if (!gridMask.empty()) glBufferSubData(GL_TEXTURE_BUFFER, 0, gridMask.size() * sizeof(GLuint), &gridMask[0]);
+	glBindBuffer(GL_TEXTURE_BUFFER, 0);
+	glUseProgram(gridProgram);
+	glUniform2f(gridCellSizeLocation, cellWidth, cellHeight);
+	glUseProgram(0);
+	// The array buffer and program bindings were changed behind bindMaterial
+	boundMaterial = -1;
+}
+
+void Renderer2D::setGridVisibility(int word, unsigned int bits) {
+	if (word < 0 || word >= (int)gridMask.size() || gridMask[word] == bits) return;
+	gridMask[word] = bits;
+	if (!gridProgram) return;
+	// One word of the buffer texture, the instances stay as they are
+	glBindBuffer(GL_TEXTURE_BUFFER, gridMaskBuffer);
+	glBufferSubData(GL_TEXTURE_BUFFER, word * sizeof(GLuint), sizeof(GLuint), &gridMask[word]);
+	glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+void Renderer2D::drawGrid(int layer) {
+	if (gridCells.empty()) return;
+	if (gridProgram) {
+		queueItem(PRIMITIVE_GRID, layer, MATERIAL_GRID, 0, 0, 0, 0, 0);
+		return;
+	}
+	// Without instancing the visible cells join the shape batch
+	for (size_t i = 0; i < gridCells.size(); i++) {
+		if (gridMask[i / 32] & (1u << (i % 32))) {
+			drawRect(gridCells[i].x, gridCells[i].y, gridCellWidth, gridCellHeight, gridCells[i].color, layer);
+		}
+	}
+}
+
+void Renderer2D::submit() {
+	stats.items = (int)queue.size();
+	stats.drawCalls = 0;
+	stats.stateChanges = 0;
+
+	std::sort(queue.begin(), queue.end(), [](const DrawItem& a, const DrawItem& b) { return a.key < b.key; });
+	if (program) {
+		submitShaders();
+	} else {
+		submitFixedFunction();
+	}
+	queue.clear();
+}
+
+void Renderer2D::bindMaterial(int material, GLuint texture) {
+	if (material != boundMaterial) {
+		switch (material) {
+			case MATERIAL_SHAPES:
+				glUseProgram(program);
+				glBindVertexArray(shapeArray);
+				glBindBuffer(GL_ARRAY_BUFFER, shapeBuffer);
+				break;
+			case MATERIAL_CIRCLES:
+				glUseProgram(circleProgram);
+				glBindVertexArray(circleArray);
+				glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+				break;
+			case MATERIAL_TEXT:
+				glUseProgram(textProgram);
+				glBindVertexArray(textArray);
+				glBindBuffer(GL_ARRAY_BUFFER, textBuffer);
+				break;
+			case MATERIAL_GRID:
+				glUseProgram(gridProgram);
+				glBindVertexArray(gridArray);
+				glBindBuffer(GL_ARRAY_BUFFER, gridCellBuffer);
+				break;
+		}
+		stats.stateChanges += 3;
+
+		// Only the distance field edges are blended
+		if ((material == MATERIAL_CIRCLES) != (boundMaterial == MATERIAL_CIRCLES)) {
+			if (material == MATERIAL_CIRCLES) {
+				glEnable(GL_BLEND);
+				glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+			} else {
+				glDisable(GL_BLEND);
+			}
+			stats.stateChanges++;
+		}
+		boundMaterial = material;
+	}
+	if (material == MATERIAL_TEXT && texture != boundTexture) {
+		glBindTexture(GL_TEXTURE_2D, texture);
+		boundTexture = texture;
+		stats.stateChanges++;
+	}
+}
+
+void Renderer2D::submitShaders() {
+	size_t i = 0;
+	while (i < queue.size()) {
+		const int material = queue[i].material;
+
+		if (material == MATERIAL_TEXT) {
+			const DrawItem& item = queue[i];
+			bindMaterial(MATERIAL_TEXT, item.font->atlasTexture());
+			glBufferData(GL_ARRAY_BUFFER, item.glyphVertices * sizeof(TextRenderer::Vertex), item.glyphs, GL_STREAM_DRAW);
+			glDrawArrays(GL_TRIANGLES, 0, (GLsizei)item.glyphVertices);
+			stats.drawCalls++;
+			i++;
+			continue;
+		}
+
+		if (material == MATERIAL_GRID) {
+			// Every cell, whatever is visible; the words were uploaded as they changed
+			bindMaterial(MATERIAL_GRID, 0);
+			glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, (GLsizei)gridCells.size());
+			stats.drawCalls++;
+			i++;
+			continue;
+		}
+
+		if (material == MATERIAL_CIRCLES) {
+			// Every circle of the run is one instance of the same quad
+			instances.clear();
+			for (; i < queue.size() && queue[i].material == MATERIAL_CIRCLES; i++) {
+				const DrawItem& item = queue[i];
+				CircleInstance instance = { item.x, item.y, item.width, (float)item.color };
+				instances.push_back(instance);
+			}
+			bindMaterial(MATERIAL_CIRCLES, 0);
+			glBufferData(GL_ARRAY_BUFFER, instances.size() * sizeof(CircleInstance), &instances[0], GL_STREAM_DRAW);
+			glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, (GLsizei)instances.size());
+			stats.drawCalls++;
+			continue;
+		}
+
+		// Consecutive shapes share one draw call since the color is a vertex attribute
+		vertices.clear();
+		for (; i < queue.size() && queue[i].material == MATERIAL_SHAPES; i++) {
+			const DrawItem& item = queue[i];
+			const float color = (float)item.color;
+			if (item.primitive == PRIMITIVE_RECT) {
+				float x0 = item.x, y0 = item.y, x1 = item.x + item.width, y1 = item.y + item.height;
+				const Vertex quad[6] = {
+					{ x0, y0, color }, { x1, y0, color }, { x1, y1, color },
+					{ x0, y0, color }, { x1, y1, color }, { x0, y1, color }
+				};
+				vertices.insert(vertices.end(), quad, quad + 6);
+			} else {
+				// The fan is split into separate triangles so it joins the shape batch
+				const float radius = item.width;
+				Vertex center = { item.x, item.y, color };
+				Vertex previous = { item.x + circleTable[0][0] * radius, item.y + circleTable[0][1] * radius, color };
+				for (int j = 1; j <= CIRCLE_SEGMENTS; j++) {
+					Vertex next = { item.x + circleTable[j][0] * radius, item.y + circleTable[j][1] * radius, color };
+					vertices.push_back(center);
+					vertices.push_back(previous);
+					vertices.push_back(next);
+					previous = next;
+				}
+			}
+		}
+		bindMaterial(MATERIAL_SHAPES, 0);
+		glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), &vertices[0], GL_STREAM_DRAW);
+		glDrawArrays(GL_TRIANGLES, 0, (GLsizei)vertices.size());
+		stats.drawCalls++;
+	}
+}
+
+void Renderer2D::submitFixedFunction() {
+	int currentColor = -1;
+	size_t i = 0;
+	while (i < queue.size()) {
+		const DrawItem& item = queue[i];
+		if (item.primitive == PRIMITIVE_TEXT) {
+			item.font->draw(item.glyphs, item.glyphVertices);
+			stats.drawCalls++;
+			stats.stateChanges++;
+			currentColor = -1; // The text color array leaves the current color undefined
+			i++;
+			continue;
+		}
+
+		if (item.color != currentColor) {
+			glColor3fv(palette[item.color]);
+			currentColor = item.color;
+			stats.stateChanges++;
+		}
+
+		if (item.primitive == PRIMITIVE_RECT) {
+			// Rectangles of the same color go into one glBegin/glEnd pair
+			glBegin(GL_QUADS);
+			for (; i < queue.size() && queue[i].primitive == PRIMITIVE_RECT && queue[i].color == currentColor; i++) {
+				const DrawItem& rect = queue[i];
+				glVertex2f(rect.x, rect.y);
+				glVertex2f(rect.x + rect.width, rect.y);
+				glVertex2f(rect.x + rect.width, rect.y + rect.height);
+				glVertex2f(rect.x, rect.y + rect.height);
+			}
+			glEnd();
+		} else {
+			glBegin(GL_TRIANGLE_FAN);
+			glVertex2f(item.x, item.y); // Center
+			for (int j = 0; j <= CIRCLE_SEGMENTS; j++) {
+				glVertex2f(item.x + circleTable[j][0] * item.width, item.y + circleTable[j][1] * item.width);
+			}
+			glEnd();
+			i++;
+		}
+		stats.drawCalls++;
+	}
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "RenderBackend.h"
+
+// Flat-colored 2D shapes and atlas text.
+// With GL 3.1 the shapes go through a small shader pipeline: the orthographic
+// projection lives in a uniform buffer that only changes on resize, and colors are
+// indices into a palette uniform buffer uploaded once. Older contexts fall back to
+// immediate mode.
+// With GL 3.3 circles are distance fields on instanced quads with anti-aliased edges,
+// otherwise they are fans built from a unit circle computed once. The grid is then one
+// instanced draw of every cell from a static buffer, and the vertex shader drops the
+// cells whose bit is clear in a buffer texture of visibility words.
+// Draws are queued and sorted by layer, material and color on submit, so state only
+// changes between runs of items that need it.
+class Renderer2D : public RenderBackend {
+public:
+	Renderer2D();
+
+	// Needs a current GL context. (width, height) is the logical size covered by the projection.
+	bool init(float width, float height);
+	void shutdown() override;
+
+	void resize(int width, int height) override;
+	void setPalette(const float colors[][3], int count) override;
+	void setClearColor(float r, float g, float b) override { glClearColor(r, g, b, 1.0f); }
+	void clear() override { glClear(GL_COLOR_BUFFER_BIT); }
+
+	void drawRect(float x, float y, float width, float height, int color, int layer = LAYER_WORLD) override;
+	void drawCircle(float x, float y, float radius, int color, int layer = LAYER_WORLD) override;
+	void drawText(const TextRenderer& font, const TextRenderer::Vertex* vertices, size_t count, int layer = LAYER_UI) override;
+	void setGrid(const GridCell* cells, int count, float cellWidth, float cellHeight) override;
+	void setGridVisibility(int word, unsigned int bits) override;
+	void drawGrid(int layer = LAYER_WORLD) override;
+	void submit() override;
+	const RenderStats& frameStats() const override { return stats; }
+
+	bool usingShaders() const { return program != 0; }
+	// Why the shader pipeline could not be used, empty if it is
+	const std::string& fallbackReason() const { return errorLog; }
+
+private:
+	struct Vertex {
+		float x, y;
+		float color;
+	};
+
+	struct CircleInstance {
+		float x, y;
+		float radius;
+		float color;
+	};
+
+	static const int CIRCLE_SEGMENTS = 20;
+
+	enum Material { MATERIAL_SHAPES, MATERIAL_CIRCLES, MATERIAL_TEXT, MATERIAL_GRID };
+	enum Primitive { PRIMITIVE_RECT, PRIMITIVE_CIRCLE, PRIMITIVE_TEXT, PRIMITIVE_GRID };
+
+	struct DrawItem {
+		uint64_t key;
+		int primitive;
+		int material;
+		int color;
+		float x, y, width, height; // Circles keep the radius in width
+		const TextRenderer* font;
+		const TextRenderer::Vertex* glyphs;
+		size_t glyphVertices;
+	};
+
+	void queueItem(int primitive, int layer, int material, int color, float x, float y, float width, float height);
+	void bindMaterial(int material, GLuint texture);
+	void submitShaders();
+	void submitFixedFunction();
+	GLuint compileProgram(const char* vertexSource, const char* fragmentSource);
+	void writeFrameBlock();
+
+	float logicalWidth, logicalHeight;
+	int viewportWidth, viewportHeight;
+	float palette[PALETTE_SIZE][4];
+	float circleTable[CIRCLE_SEGMENTS + 1][2];
+
+	GLuint program, textProgram;
+	GLuint frameUniforms, paletteUniforms;
+	GLuint shapeArray, shapeBuffer;
+	GLuint textArray, textBuffer;
+	GLuint circleProgram, circleArray, quadBuffer, instanceBuffer;
+	GLuint gridProgram, gridArray, gridCellBuffer, gridMaskBuffer, gridMaskTexture;
+	GLint gridCellSizeLocation;
+	int boundMaterial;
+	GLuint boundTexture;
+	std::vector<DrawItem> queue;
+	std::vector<Vertex> vertices;
+	std::vector<CircleInstance> instances;
+	std::vector<GridCell> gridCells; // For the fallbacks, which draw the visible cells as rects
+	std::vector<GLuint> gridMask;
+	float gridCellWidth, gridCellHeight;
+	RenderStats stats;
+	std::string errorLog;
+};
@@ -0,0 +1,209 @@
+#include "ResolutionScaler.h"
+#include <cmath>
+#include <cstring>
+
+namespace {
+	// Weight of the newest sample in the smoothed timings
+	const double SMOOTHING = 0.25;
+	// Scales are multiples of this, so small timing noise doesn't resize the target
+	const float SCALE_STEP = 0.05f;
+	// The scale only grows when the frame is this far under the target, and by one step at a time
+	const double GROW_BELOW = 0.75;
+
+	double smooth(double average, double sample) {
+		return average > 0.0 ? average + (sample - average) * SMOOTHING : sample;
+	}
+
+	// Mesa's llvmpipe and softpipe, and the older swrast
+	bool isSoftwareRenderer(const char* renderer) {
+		return renderer && (std::strstr(renderer, "llvmpipe") || std::strstr(renderer, "softpipe") ||
+			std::strstr(renderer, "Software Rasterizer"));
+	}
+}
+
+ResolutionScaler::ResolutionScaler()
+	: initialized(false), software(false), windowWidth(1), windowHeight(1), targetWidth(1), targetHeight(1),
+	  currentScale(1.0f), minScale(0.5f), maxScale(1.0f), targetMs(1000.0 / 60.0),
+	  framebuffer(0), colorTexture(0), allocatedWidth(0), allocatedHeight(0), outputFramebuffer(0), offscreen(false),
+	  queryHead(0), queriesPending(0), presented(false), gpuTime(0.0), busyTime(0.0), gpuSampled(false), nativeCost(0.0), settleFrames(0), fallbackFrames(FALLBACK_FRAMES), sizeChanged(true) {
+	for (int i = 0; i < QUERY_COUNT; i++) {
+		queries[i] = 0;
+	}
+}
+
+bool ResolutionScaler::init() {
+	shutdown();
+	if (GLVersion.major < 3) return false;
+	glGenFramebuffers(1, &framebuffer);
+	glGenTextures(1, &colorTexture);
+	software = isSoftwareRenderer((const char*)glGetString(GL_RENDERER));
+	if (!software && (GLVersion.major > 3 || GLVersion.minor >= 3)) {
+		glGenQueries(QUERY_COUNT, queries);
+	}
+	initialized = true;
+	sizeChanged = true;
+	// The first frames compile shaders and fill caches
+	settleFrames = SETTLE_FRAMES;
+	fallbackFrames = FALLBACK_FRAMES;
+	nativeCost = 0.0;
+	presented = false;
+	return true;
+}
+
+void ResolutionScaler::shutdown() {
+	if (!initialized) return;
+	glDeleteFramebuffers(1, &framebuffer);
+	glDeleteTextures(1, &colorTexture);
+	if (queries[0]) glDeleteQueries(QUERY_COUNT, queries);
+	for (int i = 0; i < QUERY_COUNT; i++) {
+		queries[i] = 0;
+	}
+	framebuffer = colorTexture = 0;
+	allocatedWidth = allocatedHeight = 0;
+	queryHead = queriesPending = 0;
+	initialized = false;
+}
+
+void ResolutionScaler::setScaleRange(float minimum, float maximum) {
+	minScale = minimum;
+	maxScale = maximum > minimum ? maximum : minimum;
+	if (currentScale < minScale) currentScale = minScale;
+	if (currentScale > maxScale) currentScale = maxScale;
+	resize(windowWidth, windowHeight);
+}
+
+void ResolutionScaler::resize(int width, int height) {
+	windowWidth = width > 0 ? width : 1;
+	windowHeight = height > 0 ? height : 1;
+	int scaledWidth = (int)(windowWidth * currentScale + 0.5f);
+	int scaledHeight = (int)(windowHeight * currentScale + 0.5f);
+	targetWidth = scaledWidth > 0 ? scaledWidth : 1;
+	targetHeight = scaledHeight > 0 ? scaledHeight : 1;
+	sizeChanged = true;
+}
+
+// Sized for full scale, so a new scale only changes the part drawn into
+void ResolutionScaler::allocateTarget() {
+	allocatedWidth = windowWidth;
+	allocatedHeight = windowHeight;
+	// The renderers leave their textures bound
+	GLint boundTexture = 0;
+	glGetIntegerv(GL_TEXTURE_BINDING_2D, &boundTexture);
+	glBindTexture(GL_TEXTURE_2D, colorTexture);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, allocatedWidth, allocatedHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glBindTexture(GL_TEXTURE_2D, boundTexture);
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, framebuffer);
+	glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colorTexture, 0);
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, outputFramebuffer);
+}
+
+bool ResolutionScaler::beginFrame() {
+	if (queries[0] && queriesPending < QUERY_COUNT) {
+		glBeginQuery(GL_TIME_ELAPSED, queries[(queryHead + queriesPending) % QUERY_COUNT]);
+	}
+
+	offscreen = targetWidth < windowWidth || targetHeight < windowHeight;
+	if (offscreen) {
+		glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &outputFramebuffer);
+		if (allocatedWidth != windowWidth || allocatedHeight != windowHeight) allocateTarget();
+		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, framebuffer);
+		// Clears stay inside the part that is shown
+		glEnable(GL_SCISSOR_TEST);
+		glScissor(0, 0, targetWidth, targetHeight);
+	}
+
+	bool changed = sizeChanged;
+	sizeChanged = false;
+	return changed;
+}
+
+void ResolutionScaler::endFrame() {
+	if (offscreen) {
+		glDisable(GL_SCISSOR_TEST);
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, outputFramebuffer);
+		glBlitFramebuffer(0, 0, targetWidth, targetHeight, 0, 0, windowWidth, windowHeight, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+		glBindFramebuffer(GL_FRAMEBUFFER, outputFramebuffer);
+	}
+	if (queries[0] && queriesPending < QUERY_COUNT) {
+		glEndQuery(GL_TIME_ELAPSED);
+		queriesPending++;
+	}
+}
+
+void ResolutionScaler::framePresented(double idleMs) {
+	Clock::time_point now = Clock::now();
+	bool first = !presented;
+	double interval = std::chrono::duration<double, std::milli>(now - lastPresent).count();
+	lastPresent = now;
+	presented = true;
+	if (first) return;
+
+	double busy = interval - idleMs;
+	busyTime = smooth(busyTime, busy > 0.0 ? busy : 0.0);
+	readQueries();
+	adjustScale();
+}
+
+// Takes the results that are ready without waiting for the GPU
+void ResolutionScaler::readQueries() {
+	while (queriesPending > 0) {
+		GLuint query = queries[queryHead];
+		GLint available = 0;
+		glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+		if (!available) break;
+		GLuint64 nanoseconds = 0;
+		glGetQueryObjectui64v(query, GL_QUERY_RESULT, &nanoseconds);
+		gpuTime = smooth(gpuTime, nanoseconds / 1e6);
+		gpuSampled = true;
+		queryHead = (queryHead + 1) % QUERY_COUNT;
+		queriesPending--;
+	}
+}
+
+void ResolutionScaler::adjustScale() {
+	if (settleFrames > 0) {
+		// The first frames at a new size allocate the target and compile the blit,
+		// so the timings start over for the last few
+		if (settleFrames == TIMED_SETTLE_FRAMES) gpuTime = busyTime = 0.0;
+		settleFrames--;
+		return;
+	}
+	double cost = gpuSampled && gpuTime > busyTime ? gpuTime : busyTime;
+	if (cost <= 0.0 || targetMs <= 0.0) return;
+	if (!offscreen) nativeCost = cost;
+
+	// The upscale has a fixed cost of its own. When it outweighs what the smaller
+	// target saves, native resolution is cheaper, so it goes back there for a while.
+	if (offscreen && cost > targetMs && nativeCost > 0.0 && cost > nativeCost) {
+		currentScale = maxScale;
+		resize(windowWidth, windowHeight);
+		settleFrames = fallbackFrames;
+		if (fallbackFrames < MAX_FALLBACK_FRAMES) fallbackFrames *= 2;
+		return;
+	}
+	if (offscreen) fallbackFrames = FALLBACK_FRAMES;
+
+	// The cost grows with the pixel count, the square of the scale. Shrinking happens
+	// at once, growing one step at a time so it doesn't overshoot back over the target.
+	float desired = currentScale * (float)std::sqrt(targetMs / cost);
+	float next;
+	if (cost > targetMs) {
+		next = desired;
+	} else if (cost < targetMs * GROW_BELOW) {
+		next = desired < currentScale + SCALE_STEP ? desired : currentScale + SCALE_STEP;
+	} else {
+		return;
+	}
+	// Rounded down when shrinking, so a frame just over the target still shrinks
+	next = (cost > targetMs ? std::floor(next / SCALE_STEP + 0.001f) : std::floor(next / SCALE_STEP + 0.5f)) * SCALE_STEP;
+	if (next < minScale) next = minScale;
+	if (next > maxScale) next = maxScale;
+	if (std::fabs(next - currentScale) < SCALE_STEP * 0.5f) return;
+
+	currentScale = next;
+	resize(windowWidth, windowHeight);
+	settleFrames = SETTLE_FRAMES;
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <chrono>
+
+// Dynamic resolution (--dynamic-resolution).
+// The scene is drawn into a framebuffer object at a fraction of the window's size and
+// stretched over the window with a filtered blit. After every frame the fraction is
+// adjusted to keep the frame's cost near the target time. The cost is the larger of
+// the GPU time, from timer queries read back a few frames later, and the time the
+// thread was busy from one present to the next, which on software GL is where the
+// drawing happens. At full scale the scene goes straight to the window, without the
+// extra copy; when that copy costs more than it saves (a cheap scene, or a software
+// rasterizer) the scale falls back to full for a few seconds before trying again, twice
+// as long each time it still doesn't pay off.
+class ResolutionScaler {
+public:
+	ResolutionScaler();
+
+	// Needs a current context with framebuffer blits (GL 3.0). Timer queries (GL 3.3)
+	// are used when available and the GL isn't a software rasterizer, whose queries
+	// time nothing and stall on readback; otherwise only the busy time counts.
+	bool init();
+	void shutdown();
+	bool active() const { return initialized; }
+
+	// The window's framebuffer size, from the reshape callback
+	void resize(int width, int height);
+	// Frame time to hold, in milliseconds
+	void setTargetFrameTime(double milliseconds) { targetMs = milliseconds; }
+	void setScaleRange(float minimum, float maximum);
+
+	// Binds the target to draw into. Returns true when the render size changed since
+	// the previous frame, so the projection's viewport needs updating.
+	bool beginFrame();
+	// Stretches the frame over the window
+	void endFrame();
+	// Call once the frame is presented, with the milliseconds the thread spent waiting
+	// since the previous present: pacing, events, the next frame's commands. The rest
+	// of the interval is the frame's busy time. Updates the scale from the timings.
+	void framePresented(double idleMs);
+
+	int renderWidth() const { return targetWidth; }
+	int renderHeight() const { return targetHeight; }
+	float scale() const { return currentScale; }
+	double targetFrameMs() const { return targetMs; }
+	// Smoothed timings that drove the last adjustment, in milliseconds
+	double gpuMs() const { return gpuTime; }
+	double busyMs() const { return busyTime; }
+	bool hasGpuTimer() const { return queries[0] != 0; }
+	bool softwareRasterizer() const { return software; }
+
+private:
+	typedef std::chrono::steady_clock Clock;
+
+	static const int QUERY_COUNT = 4; // Frames a timer result may lag behind
+	static const int SETTLE_FRAMES = 8; // After a change, so the timings reflect the new size
+	static const int TIMED_SETTLE_FRAMES = 4; // The last settling frames, the ones that are timed
+	static const int FALLBACK_FRAMES = 300; // At native size, after scaling down didn't pay off
+	static const int MAX_FALLBACK_FRAMES = 4800;
+
+	void allocateTarget();
+	void readQueries();
+	void adjustScale();
+
+	bool initialized;
+	bool software;
+	int windowWidth, windowHeight;
+	int targetWidth, targetHeight;
+	float currentScale, minScale, maxScale;
+	double targetMs;
+	GLuint framebuffer, colorTexture;
+	int allocatedWidth, allocatedHeight;
+	GLint outputFramebuffer; // Where the frame is presented from
+	bool offscreen; // Whether this frame draws into the target
+
+	GLuint queries[QUERY_COUNT];
+	int queryHead, queriesPending;
+	Clock::time_point lastPresent;
+	bool presented; // Whether lastPresent is set
+	double gpuTime, busyTime;
+	bool gpuSampled;
+	double nativeCost; // Last cost measured at native size
+	int settleFrames;
+	int fallbackFrames; // The next fallback's length
+	bool sizeChanged;
+};
@@ -0,0 +1,351 @@
+#include "SoftwareRenderer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace {
+	// Pixels whose centers are at or right of x, GL's rasterization rule
+	int firstPixel(float x) {
+		return (int)std::ceil(x - 0.5f);
+	}
+
+	int clampInt(int value, int low, int high) {
+		return value < low ? low : value > high ? high : value;
+	}
+
+	void fillSpan(uint32_t* pixels, int x0, int x1, uint32_t color) {
+		int x = x0;
+#ifdef __SSE2__
+		// Up to the first 16 byte boundary one by one, then four pixels per store
+		for (; x < x1 && ((uintptr_t)(pixels + x) & 15) != 0; x++) {
+			pixels[x] = color;
+		}
+		const __m128i value = _mm_set1_epi32((int)color);
+		for (; x + 4 <= x1; x += 4) {
+			_mm_store_si128((__m128i*)(pixels + x), value);
+		}
+#endif
+		for (; x < x1; x++) {
+			pixels[x] = color;
+		}
+	}
+
+	// coverage is 0 to 256. Channels are whole bytes, so two of them are blended per
+	// multiply whatever their order.
+	uint32_t blend(uint32_t destination, uint32_t source, uint32_t coverage) {
+		uint32_t inverse = 256 - coverage;
+		uint32_t redBlue = ((source & 0x00ff00ff) * coverage + (destination & 0x00ff00ff) * inverse) >> 8;
+		uint32_t greenAlpha = ((source >> 8) & 0x00ff00ff) * coverage + ((destination >> 8) & 0x00ff00ff) * inverse;
+		return (redBlue & 0x00ff00ff) | (greenAlpha & 0xff00ff00);
+	}
+
+	uint8_t channel(float value) {
+		return (uint8_t)(clampInt((int)(value * 255.0f + 0.5f), 0, 255));
+	}
+}
+
+SoftwareRenderer::SoftwareRenderer()
+	: logicalWidth(1.0f), logicalHeight(1.0f), scaleX(1.0f), scaleY(1.0f), toWindow(false), pixels(NULL),
+	  targetWidth(0), targetHeight(0), stride(0), packedClear(0), gridCellWidth(0.0f), gridCellHeight(0.0f) {
+	// Byte order R, G, B in memory, the same as an RGBA framebuffer
+	shifts[0] = 0;
+	shifts[1] = 8;
+	shifts[2] = 16;
+	for (int i = 0; i < PALETTE_SIZE; i++) {
+		palette[i][0] = palette[i][1] = palette[i][2] = 1.0f;
+		packedPalette[i] = 0;
+	}
+	clearColor[0] = clearColor[1] = clearColor[2] = 0.0f;
+	stats.items = stats.drawCalls = stats.stateChanges = 0;
+}
+
+bool SoftwareRenderer::init(float width, float height, bool presentToWindow) {
+	shutdown();
+	logicalWidth = width;
+	logicalHeight = height;
+	toWindow = presentToWindow;
+	if (toWindow && !window.create((int)width, (int)height)) return false;
+	resize((int)width, (int)height);
+	return pixels != NULL;
+}
+
+void SoftwareRenderer::shutdown() {
+	window.destroy();
+	memory.clear();
+	pixels = NULL;
+	targetWidth = targetHeight = stride = 0;
+	queue.clear();
+}
+
+void SoftwareRenderer::resize(int width, int height) {
+	width = width > 0 ? width : 1;
+	height = height > 0 ? height : 1;
+	if (toWindow) {
+		if (window.resize(width, height)) {
+			pixels = window.pixels();
+			stride = window.stride();
+			shifts[0] = window.redShift();
+			shifts[1] = window.greenShift();
+			shifts[2] = window.blueShift();
+		} else {
+			pixels = NULL;
+		}
+	} else {
+		memory.assign((size_t)width * height, 0);
+		pixels = &memory[0];
+		stride = width;
+	}
+	targetWidth = pixels ? width : 0;
+	targetHeight = pixels ? height : 0;
+	scaleX = width / logicalWidth;
+	scaleY = height / logicalHeight;
+
+	// The channel order may have changed with the image
+	for (int i = 0; i < PALETTE_SIZE; i++) {
+		packedPalette[i] = pack(channel(palette[i][0]), channel(palette[i][1]), channel(palette[i][2]));
+	}
+	packedClear = pack(channel(clearColor[0]), channel(clearColor[1]), channel(clearColor[2]));
+}
+
+uint32_t SoftwareRenderer::pack(int r, int g, int b) const {
+	return ((uint32_t)r << shifts[0]) | ((uint32_t)g << shifts[1]) | ((uint32_t)b << shifts[2]);
+}
+
+void SoftwareRenderer::setPalette(const float colors[][3], int count) {
+	for (int i = 0; i < count && i < PALETTE_SIZE; i++) {
+		palette[i][0] = colors[i][0];
+		palette[i][1] = colors[i][1];
+		palette[i][2] = colors[i][2];
+		packedPalette[i] = pack(channel(colors[i][0]), channel(colors[i][1]), channel(colors[i][2]));
+	}
+}
+
+void SoftwareRenderer::setClearColor(float r, float g, float b) {
+	clearColor[0] = r;
+	clearColor[1] = g;
+	clearColor[2] = b;
+	packedClear = pack(channel(r), channel(g), channel(b));
+}
+
+void SoftwareRenderer::clear() {
+	if (!pixels) return;
+	if (stride == targetWidth) {
+		fillSpan(pixels, 0, targetWidth * targetHeight, packedClear);
+		return;
+	}
+	for (int y = 0; y < targetHeight; y++) {
+		fillSpan(row(y), 0, targetWidth, packedClear);
+	}
+}
+
+void SoftwareRenderer::queueItem(int primitive, int layer, int color, float x, float y, float width, float height) {
+	DrawItem item;
+	item.key = ((uint64_t)layer << 32) | (uint32_t)queue.size();
+	item.primitive = primitive;
+	item.color = color;
+	item.x = x;
+	item.y = y;
+	item.width = width;
+	item.height = height;
+	item.font = NULL;
+	item.glyphs = NULL;
+	item.glyphVertices = 0;
+	queue.push_back(item);
+}
+
+void SoftwareRenderer::drawRect(float x, float y, float width, float height, int color, int layer) {
+	queueItem(PRIMITIVE_RECT, layer, color, x, y, width, height);
+}
+
+void SoftwareRenderer::drawCircle(float x, float y, float radius, int color, int layer) {
+	queueItem(PRIMITIVE_CIRCLE, layer, color, x, y, radius, radius);
+}
+
+void SoftwareRenderer::drawText(const TextRenderer& font, const TextRenderer::Vertex* vertices, size_t count, int layer) {
+	if (count == 0) return;
+	queueItem(PRIMITIVE_TEXT, layer, 0, 0, 0, 0, 0);
+	queue.back().font = &font;
+	queue.back().glyphs = vertices;
+	queue.back().glyphVertices = count;
+}
+
+void SoftwareRenderer::setGrid(const GridCell* cells, int count, float cellWidth, float cellHeight) {
+	gridCells.assign(cells, cells + count);
+	gridMask.assign((count + 31) / 32, 0);
+	gridCellWidth = cellWidth;
+	gridCellHeight = cellHeight;
+}
+
+void SoftwareRenderer::setGridVisibility(int word, unsigned int bits) {
+	if (word >= 0 && word < (int)gridMask.size()) gridMask[word] = bits;
+}
+
+void SoftwareRenderer::drawGrid(int layer) {
+	if (!gridCells.empty()) queueItem(PRIMITIVE_GRID, layer, 0, 0, 0, 0, 0);
+}
+
+void SoftwareRenderer::submit() {
+	// Every item is drawn on its own, there is no state to change
+	stats.items = (int)queue.size();
+	stats.drawCalls = 0;
+	stats.stateChanges = 0;
+
+	std::sort(queue.begin(), queue.end(), [](const DrawItem& a, const DrawItem& b) { return a.key < b.key; });
+	for (size_t i = 0; i < queue.size(); i++) {
+		const DrawItem& item = queue[i];
+		if (!pixels) {
+			continue;
+		} else if (item.primitive == PRIMITIVE_TEXT) {
+			fillText(item);
+		} else if (item.primitive == PRIMITIVE_GRID) {
+			fillGrid();
+		} else if (item.primitive == PRIMITIVE_RECT) {
+			fillRect(item);
+		} else {
+			fillCircle(item);
+		}
+		stats.drawCalls++;
+	}
+	queue.clear();
+}
+
+void SoftwareRenderer::fillRect(const DrawItem& item) {
+	const int x0 = clampInt(firstPixel(item.x * scaleX), 0, targetWidth);
+	const int x1 = clampInt(firstPixel((item.x + item.width) * scaleX), 0, targetWidth);
+	const int y0 = clampInt(firstPixel(item.y * scaleY), 0, targetHeight);
+	const int y1 = clampInt(firstPixel((item.y + item.height) * scaleY), 0, targetHeight);
+	if (x0 >= x1) return;
+	const uint32_t color = packedPalette[item.color];
+	for (int y = y0; y < y1; y++) {
+		fillSpan(row(y), x0, x1, color);
+	}
+}
+
+// Walks the visibility words, skipping 32 hidden cells at a time
+void SoftwareRenderer::fillGrid() {
+	DrawItem cell;
+	cell.width = gridCellWidth;
+	cell.height = gridCellHeight;
+	for (size_t word = 0; word < gridMask.size(); word++) {
+		for (uint32_t bits = gridMask[word]; bits; bits &= bits - 1) {
+			int bit = 0;
+			while (!(bits & (1u << bit))) bit++;
+			const GridCell& source = gridCells[word * 32 + bit];
+			cell.x = source.x;
+			cell.y = source.y;
+			cell.color = source.color;
+			fillRect(cell);
+		}
+	}
+}
+
+// Each row is a solid span between two short runs of edge pixels, whose coverage comes
+// from the distance to the center like the GL distance field. Distances are in logical
+// units, so a stretched window gets an ellipse as on the GL path.
+void SoftwareRenderer::fillCircle(const DrawItem& item) {
+	const float radius = item.width;
+	const float pixel = 2.0f / (scaleX + scaleY); // Logical size of a pixel, for the edge width
+	const float outer = radius + 0.5f * pixel;
+	const float inner = radius - 0.5f * pixel;
+	const uint32_t color = packedPalette[item.color];
+
+	const int y0 = clampInt(firstPixel((item.y - outer) * scaleY), 0, targetHeight);
+	const int y1 = clampInt(firstPixel((item.y + outer) * scaleY), 0, targetHeight);
+	for (int y = y0; y < y1; y++) {
+		const float dy = (y + 0.5f) / scaleY - item.y;
+		const float outerSquared = outer * outer - dy * dy;
+		if (outerSquared <= 0.0f) continue;
+		const float outerHalf = std::sqrt(outerSquared);
+		const int x0 = clampInt(firstPixel((item.x - outerHalf) * scaleX), 0, targetWidth);
+		const int x1 = clampInt(firstPixel((item.x + outerHalf) * scaleX), 0, targetWidth);
+
+		int solid0 = x1, solid1 = x1;
+		const float innerSquared = inner * inner - dy * dy;
+		if (inner > 0.0f && innerSquared > 0.0f) {
+			const float innerHalf = std::sqrt(innerSquared);
+			solid0 = clampInt(firstPixel((item.x - innerHalf) * scaleX), x0, x1);
+			solid1 = clampInt(firstPixel((item.x + innerHalf) * scaleX), solid0, x1);
+		}
+
+		uint32_t* out = row(y);
+		for (int x = x0; x < x1; x++) {
+			if (x == solid0) {
+				fillSpan(out, solid0, solid1, color);
+				x = solid1;
+				if (x >= x1) break;
+			}
+			const float dx = (x + 0.5f) / scaleX - item.x;
+			const float coverage = (radius - std::sqrt(dx * dx + dy * dy)) / pixel + 0.5f;
+			if (coverage >= 1.0f) {
+				out[x] = color;
+			} else if (coverage > 0.0f) {
+				out[x] = blend(out[x], color, (uint32_t)(coverage * 256.0f));
+			}
+		}
+	}
+}
+
+// Glyph quads are axis aligned and the atlas is sampled at pixel centers, with the
+// GL path's alpha test
+void SoftwareRenderer::fillText(const DrawItem& item) {
+	const TextRenderer::Vertex* glyphs = item.glyphs;
+	const GLubyte* atlas = item.font->atlasPixels();
+	if (!atlas) return;
+	const int atlasWidth = item.font->atlasWidth();
+	const int atlasHeight = item.font->atlasHeight();
+
+	// Six vertices per glyph; the first and the third are opposite corners
+	for (size_t i = 0; i + 6 <= item.glyphVertices; i += 6) {
+		const TextRenderer::Vertex& a = glyphs[i];
+		const TextRenderer::Vertex& b = glyphs[i + 2];
+		const float left = a.x * scaleX, right = b.x * scaleX;
+		const float bottom = a.y * scaleY, top = b.y * scaleY;
+		const int x0 = clampInt(firstPixel(left), 0, targetWidth);
+		const int x1 = clampInt(firstPixel(right), 0, targetWidth);
+		const int y0 = clampInt(firstPixel(bottom), 0, targetHeight);
+		const int y1 = clampInt(firstPixel(top), 0, targetHeight);
+		if (x0 >= x1 || y0 >= y1) continue;
+
+		// Texels per pixel
+		const float du = (b.u - a.u) * atlasWidth / (right - left);
+		const float dv = (b.v - a.v) * atlasHeight / (top - bottom);
+		const float u0 = a.u * atlasWidth + (x0 + 0.5f - left) * du;
+		const uint32_t color = pack(a.r, a.g, a.b);
+		for (int y = y0; y < y1; y++) {
+			const int texelY = clampInt((int)(a.v * atlasHeight + (y + 0.5f - bottom) * dv), 0, atlasHeight - 1);
+			const GLubyte* texels = atlas + (size_t)texelY * atlasWidth;
+			uint32_t* out = row(y);
+			float u = u0;
+			for (int x = x0; x < x1; x++, u += du) {
+				if (texels[clampInt((int)u, 0, atlasWidth - 1)] > 127) out[x] = color;
+			}
+		}
+	}
+}
+
+void SoftwareRenderer::present() {
+	if (toWindow) window.present();
+}
+
+bool SoftwareRenderer::writeImage(const char* path) const {
+	if (!pixels) return false;
+	FILE* file = fopen(path, "wb");
+	if (!file) return false;
+	fprintf(file, "P6\n%d %d\n255\n", targetWidth, targetHeight);
+	std::vector<unsigned char> line((size_t)targetWidth * 3);
+	bool written = true;
+	// The top row is first in memory as well
+	for (int y = 0; y < targetHeight && written; y++) {
+		const uint32_t* in = pixels + (size_t)y * stride;
+		for (int x = 0; x < targetWidth; x++) {
+			line[x * 3 + 0] = (unsigned char)(in[x] >> shifts[0]);
+			line[x * 3 + 1] = (unsigned char)(in[x] >> shifts[1]);
+			line[x * 3 + 2] = (unsigned char)(in[x] >> shifts[2]);
+		}
+		written = fwrite(&line[0], 1, line.size(), file) == line.size();
+	}
+	return fclose(file) == 0 && written;
+}
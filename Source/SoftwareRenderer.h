@@ -0,0 +1,83 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+#include "RenderBackend.h"
+#include "XShmSurface.h"
+
+// CPU rasterizer for machines without a usable GL driver (--software).
+// Every primitive is scan converted into horizontal spans of whole pixels, which are
+// filled four pixels per store with SSE2. Rectangles are a run of identical spans,
+// circles get an anti-aliased edge like the GL distance field, and text is sampled
+// from the glyph atlas with the same alpha test as the GL path.
+// Frames are drawn straight into a shared memory XImage and presented with
+// XShmPutImage; without a window (--headless) they are kept in memory.
+class SoftwareRenderer : public RenderBackend {
+public:
+	SoftwareRenderer();
+
+	// (width, height) is the logical size. With toWindow the window of the current
+	// GLX context is drawn into, see XShmSurface.
+	bool init(float width, float height, bool toWindow);
+	void shutdown() override;
+
+	void resize(int width, int height) override;
+	void setPalette(const float colors[][3], int count) override;
+	void setClearColor(float r, float g, float b) override;
+	void clear() override;
+
+	void drawRect(float x, float y, float width, float height, int color, int layer = LAYER_WORLD) override;
+	void drawCircle(float x, float y, float radius, int color, int layer = LAYER_WORLD) override;
+	void drawText(const TextRenderer& font, const TextRenderer::Vertex* vertices, size_t count, int layer = LAYER_UI) override;
+	void setGrid(const GridCell* cells, int count, float cellWidth, float cellHeight) override;
+	void setGridVisibility(int word, unsigned int bits) override;
+	void drawGrid(int layer = LAYER_WORLD) override;
+	void submit() override;
+	const RenderStats& frameStats() const override { return stats; }
+
+	// Shows the frame in the window, nothing without one
+	void present();
+	// Writes the frame as a binary PPM image
+	bool writeImage(const char* path) const;
+	const XShmSurface& surface() const { return window; }
+
+private:
+	enum Primitive { PRIMITIVE_RECT, PRIMITIVE_CIRCLE, PRIMITIVE_TEXT, PRIMITIVE_GRID };
+
+	struct DrawItem {
+		uint64_t key; // Layer, then submission order
+		int primitive;
+		int color;
+		float x, y, width, height; // Circles keep the radius in width
+		const TextRenderer* font;
+		const TextRenderer::Vertex* glyphs;
+		size_t glyphVertices;
+	};
+
+	void queueItem(int primitive, int layer, int color, float x, float y, float width, float height);
+	void bindTarget();
+	uint32_t pack(int r, int g, int b) const;
+	uint32_t* row(int y) const { return pixels + (size_t)(targetHeight - 1 - y) * stride; } // y counts from the bottom
+	void fillRect(const DrawItem& item);
+	void fillCircle(const DrawItem& item);
+	void fillText(const DrawItem& item);
+	void fillGrid();
+
+	float logicalWidth, logicalHeight;
+	float scaleX, scaleY; // Pixels per logical unit
+	XShmSurface window;
+	bool toWindow;
+	std::vector<uint32_t> memory; // The frame when there is no window
+	uint32_t* pixels;
+	int targetWidth, targetHeight, stride;
+	int shifts[3];
+	float palette[PALETTE_SIZE][3];
+	uint32_t packedPalette[PALETTE_SIZE];
+	float clearColor[3];
+	uint32_t packedClear;
+	std::vector<DrawItem> queue;
+	std::vector<GridCell> gridCells;
+	std::vector<uint32_t> gridMask;
+	float gridCellWidth, gridCellHeight;
+	RenderStats stats;
+};
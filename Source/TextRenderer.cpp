@@ -0,0 +1,261 @@
+#include "TextRenderer.h"
+#include <GL/freeglut.h>
+
+// Empty pixels kept around every glyph cell while rasterizing and in the atlas
+const int GLYPH_PADDING = 2;
+const int ATLAS_COLUMNS = 16;
+
+TextRenderer::TextRenderer() : texture(0), fontHeight(0) {
+	for (int i = 0; i <= LAST_CHAR - FIRST_CHAR; i++) {
+		glyphs[i] = Glyph();
+	}
+}
+
+bool TextRenderer::init(void* font) {
+	shutdown();
+
+	fontHeight = glutBitmapHeight(font);
+	int maxAdvance = 0;
+	for (int c = FIRST_CHAR; c <= LAST_CHAR; c++) {
+		int advance = glutBitmapWidth(font, c);
+		if (advance > maxAdvance) maxAdvance = advance;
+	}
+	if (fontHeight <= 0 || maxAdvance <= 0) return false;
+
+	// Cells are twice the font height so the descent fits whatever the font's y origin is
+	const int glyphCount = LAST_CHAR - FIRST_CHAR + 1;
+	const int cellWidth = maxAdvance + 2 * GLYPH_PADDING;
+	const int cellHeight = fontHeight * 2;
+	const int rows = (glyphCount + ATLAS_COLUMNS - 1) / ATLAS_COLUMNS;
+	const int captureWidth = cellWidth * ATLAS_COLUMNS;
+
+	std::vector<GLubyte> capture;
+	if (!rasterizeGlyphs(font, cellWidth, cellHeight, ATLAS_COLUMNS, rows, capture)) return false;
+
+	// Find the tight bounds of every glyph and shelf-pack them into the atlas
+	int minX[glyphCount], minY[glyphCount];
+	int penX = GLYPH_PADDING, penY = GLYPH_PADDING, shelfHeight = 0;
+	for (int i = 0; i < glyphCount; i++) {
+		int cellX = (i % ATLAS_COLUMNS) * cellWidth;
+		int cellY = (i / ATLAS_COLUMNS) * cellHeight;
+		int x0 = cellWidth, y0 = cellHeight, x1 = -1, y1 = -1;
+		for (int y = 0; y < cellHeight; y++) {
+			for (int x = 0; x < cellWidth; x++) {
+				if (capture[((cellY + y) * captureWidth + cellX + x) * 4] > 127) {
+					if (x < x0) x0 = x;
+					if (y < y0) y0 = y;
+					if (x > x1) x1 = x;
+					if (y > y1) y1 = y;
+				}
+			}
+		}
+
+		Glyph& glyph = glyphs[i];
+		glyph.advance = glutBitmapWidth(font, FIRST_CHAR + i);
+		glyph.width = x1 >= x0 ? x1 - x0 + 1 : 0;
+		glyph.height = y1 >= y0 ? y1 - y0 + 1 : 0;
+		glyph.offsetX = x0 - GLYPH_PADDING;
+		glyph.offsetY = y0 - fontHeight;
+		minX[i] = cellX + x0;
+		minY[i] = cellY + y0;
+		if (glyph.width == 0) continue; // Space
+
+		if (penX + glyph.width + GLYPH_PADDING > ATLAS_WIDTH) {
+			penX = GLYPH_PADDING;
+			penY += shelfHeight + GLYPH_PADDING;
+			shelfHeight = 0;
+		}
+		// Store the atlas position in the texture coordinates until the atlas size is known
+		glyph.u0 = (float)penX;
+		glyph.v0 = (float)penY;
+		penX += glyph.width + GLYPH_PADDING;
+		if (glyph.height > shelfHeight) shelfHeight = glyph.height;
+	}
+
+	int atlasHeight = 1;
+	while (atlasHeight < penY + shelfHeight + GLYPH_PADDING) atlasHeight *= 2;
+
+	atlas.assign(ATLAS_WIDTH * atlasHeight, 0);
+	for (int i = 0; i < glyphCount; i++) {
+		Glyph& glyph = glyphs[i];
+		if (glyph.width == 0) continue;
+		int atlasX = (int)glyph.u0, atlasY = (int)glyph.v0;
+		for (int y = 0; y < glyph.height; y++) {
+			for (int x = 0; x < glyph.width; x++) {
+				atlas[(atlasY + y) * ATLAS_WIDTH + atlasX + x] = capture[((minY[i] + y) * captureWidth + minX[i] + x) * 4];
+			}
+		}
+		glyph.u0 = (float)atlasX / ATLAS_WIDTH;
+		glyph.v0 = (float)atlasY / atlasHeight;
+		glyph.u1 = (float)(atlasX + glyph.width) / ATLAS_WIDTH;
+		glyph.v1 = (float)(atlasY + glyph.height) / atlasHeight;
+	}
+
+	glGenTextures(1, &texture);
+	glBindTexture(GL_TEXTURE_2D, texture);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_ALPHA8, ATLAS_WIDTH, atlasHeight, 0, GL_ALPHA, GL_UNSIGNED_BYTE, &atlas[0]);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	vertices.reserve(256 * 6);
+	return glGetError() == GL_NO_ERROR;
+}
+
+bool TextRenderer::rasterizeGlyphs(void* font, int cellWidth, int cellHeight, int columns, int rows, std::vector<GLubyte>& pixels) {
+	const int width = cellWidth * columns;
+	const int height = cellHeight * rows;
+
+	// Draw into an offscreen framebuffer when possible so the window size and visibility do not matter
+	GLuint framebuffer = 0, colorBuffer = 0;
+	GLint previousFramebuffer = 0;
+	if (GLAD_GL_VERSION_3_0) {
+		glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previousFramebuffer);
+		glGenRenderbuffers(1, &colorBuffer);
+		glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer);
+		glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+		glBindRenderbuffer(GL_RENDERBUFFER, 0);
+		glGenFramebuffers(1, &framebuffer);
+		glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer);
+		if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+			glBindFramebuffer(GL_FRAMEBUFFER, previousFramebuffer);
+			glDeleteFramebuffers(1, &framebuffer);
+			glDeleteRenderbuffers(1, &colorBuffer);
+			framebuffer = 0;
+		}
+	}
+	if (!framebuffer) {
+		// The back buffer is overwritten by the first frame anyway
+		if (width > glutGet(GLUT_WINDOW_WIDTH) || height > glutGet(GLUT_WINDOW_HEIGHT)) return false;
+		glDrawBuffer(GL_BACK);
+		glReadBuffer(GL_BACK);
+	}
+
+	GLint viewport[4];
+	glGetIntegerv(GL_VIEWPORT, viewport);
+	glViewport(0, 0, width, height);
+	glMatrixMode(GL_PROJECTION);
+	glPushMatrix();
+	glLoadIdentity();
+	glOrtho(0, width, 0, height, -1, 1);
+	glMatrixMode(GL_MODELVIEW);
+	glPushMatrix();
+	glLoadIdentity();
+
+	glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+	glClear(GL_COLOR_BUFFER_BIT);
+	glColor3f(1.0f, 1.0f, 1.0f);
+	for (int c = FIRST_CHAR; c <= LAST_CHAR; c++) {
+		int i = c - FIRST_CHAR;
+		glRasterPos2i((i % columns) * cellWidth + GLYPH_PADDING, (i / columns) * cellHeight + fontHeight);
+		glutBitmapCharacter(font, c);
+	}
+
+	pixels.resize(width * height * 4);
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, &pixels[0]);
+	glPixelStorei(GL_PACK_ALIGNMENT, 4);
+
+	glMatrixMode(GL_PROJECTION);
+	glPopMatrix();
+	glMatrixMode(GL_MODELVIEW);
+	glPopMatrix();
+	glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+
+	if (framebuffer) {
+		glBindFramebuffer(GL_FRAMEBUFFER, previousFramebuffer);
+		glDeleteFramebuffers(1, &framebuffer);
+		glDeleteRenderbuffers(1, &colorBuffer);
+	}
+	return true;
+}
+
+void TextRenderer::shutdown() {
+	if (texture) {
+		glDeleteTextures(1, &texture);
+		texture = 0;
+	}
+	atlas.clear();
+	vertices.clear();
+}
+
+void TextRenderer::addText(float x, float y, const char* text, float r, float g, float b) {
+	appendText(vertices, x, y, text, r, g, b);
+}
+
+void TextRenderer::buildMesh(Mesh& mesh, float x, float y, const char* text, float r, float g, float b) const {
+	mesh.clear();
+	appendText(mesh, x, y, text, r, g, b);
+}
+
+void TextRenderer::addMesh(const Mesh& mesh) {
+	vertices.insert(vertices.end(), mesh.begin(), mesh.end());
+}
+
+void TextRenderer::appendText(std::vector<Vertex>& out, float x, float y, const char* text, float r, float g, float b) const {
+	Vertex vertex;
+	vertex.r = (GLubyte)(r * 255.0f);
+	vertex.g = (GLubyte)(g * 255.0f);
+	vertex.b = (GLubyte)(b * 255.0f);
+	vertex.a = 255;
+
+	for (const char* c = text; *c != '\0'; c++) {
+		if (*c < FIRST_CHAR || *c > LAST_CHAR) continue;
+		const Glyph& glyph = glyphs[*c - FIRST_CHAR];
+		if (glyph.width > 0) {
+			float x0 = x + glyph.offsetX, y0 = y + glyph.offsetY;
+			float x1 = x0 + glyph.width, y1 = y0 + glyph.height;
+			const float corners[6][4] = {
+				{ x0, y0, glyph.u0, glyph.v0 }, { x1, y0, glyph.u1, glyph.v0 }, { x1, y1, glyph.u1, glyph.v1 },
+				{ x0, y0, glyph.u0, glyph.v0 }, { x1, y1, glyph.u1, glyph.v1 }, { x0, y1, glyph.u0, glyph.v1 }
+			};
+			for (int i = 0; i < 6; i++) {
+				vertex.x = corners[i][0];
+				vertex.y = corners[i][1];
+				vertex.u = corners[i][2];
+				vertex.v = corners[i][3];
+				out.push_back(vertex);
+			}
+		}
+		x += glyph.advance;
+	}
+}
+
+void TextRenderer::draw(const Vertex* quads, size_t count) const {
+	if (count == 0 || !texture) return;
+
+	glEnable(GL_TEXTURE_2D);
+	glBindTexture(GL_TEXTURE_2D, texture);
+	glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+	// Glyphs are either fully on or off, like glBitmap output
+	glEnable(GL_ALPHA_TEST);
+	glAlphaFunc(GL_GREATER, 0.5f);
+
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	glEnableClientState(GL_COLOR_ARRAY);
+	glVertexPointer(2, GL_FLOAT, sizeof(Vertex), &quads[0].x);
+	glTexCoordPointer(2, GL_FLOAT, sizeof(Vertex), &quads[0].u);
+	glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(Vertex), &quads[0].r);
+	glDrawArrays(GL_TRIANGLES, 0, (GLsizei)count);
+	glDisableClientState(GL_COLOR_ARRAY);
+	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+	glDisableClientState(GL_VERTEX_ARRAY);
+
+	glDisable(GL_ALPHA_TEST);
+	glBindTexture(GL_TEXTURE_2D, 0);
+	glDisable(GL_TEXTURE_2D);
+}
+
+int TextRenderer::textWidth(const char* text) const {
+	int width = 0;
+	for (const char* c = text; *c != '\0'; c++) {
+		if (*c >= FIRST_CHAR && *c <= LAST_CHAR) width += glyphs[*c - FIRST_CHAR].advance;
+	}
+	return width;
+}
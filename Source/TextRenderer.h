@@ -0,0 +1,69 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <vector>
+
+// Bitmap text drawn from a texture atlas.
+// The glyphs of a GLUT bitmap font are rasterized once with glutBitmapCharacter,
+// read back, and packed into a single alpha texture. Strings are then appended
+// to a quad batch that a renderer submits with one draw call.
+class TextRenderer {
+public:
+	struct Vertex {
+		float x, y;
+		float u, v;
+		GLubyte r, g, b, a;
+	};
+
+	// Quads for a string that is drawn many times but rarely changes
+	typedef std::vector<Vertex> Mesh;
+
+	TextRenderer();
+
+	// Builds the atlas for the given GLUT bitmap font. Needs a current GL context.
+	bool init(void* font);
+	void shutdown();
+
+	// Appends a string to the batch. (x, y) is the pen position on the baseline,
+	// the same as glRasterPos2f for glutBitmapCharacter.
+	void addText(float x, float y, const char* text, float r = 1.0f, float g = 1.0f, float b = 1.0f);
+	// Same as addText, but into a mesh that can be appended again with addMesh.
+	void buildMesh(Mesh& mesh, float x, float y, const char* text, float r = 1.0f, float g = 1.0f, float b = 1.0f) const;
+	void addMesh(const Mesh& mesh);
+	// Draws glyph quads, e.g. the batch, with the fixed-function pipeline
+	void draw(const Vertex* quads, size_t count) const;
+	// Everything appended since the last clear
+	const std::vector<Vertex>& batch() const { return vertices; }
+	GLuint atlasTexture() const { return texture; }
+	// The atlas alpha, rows bottom first, for renderers that sample it on the CPU
+	const GLubyte* atlasPixels() const { return atlas.empty() ? NULL : &atlas[0]; }
+	int atlasWidth() const { return atlas.empty() ? 0 : ATLAS_WIDTH; }
+	int atlasHeight() const { return atlas.empty() ? 0 : (int)(atlas.size() / ATLAS_WIDTH); }
+	void clear() { vertices.clear(); }
+
+	int textWidth(const char* text) const;
+	int lineHeight() const { return fontHeight; }
+	size_t pendingGlyphs() const { return vertices.size() / 6; }
+
+private:
+	struct Glyph {
+		float u0, v0, u1, v1;
+		int width, height;	// Size of the glyph bitmap in pixels
+		int offsetX, offsetY;	// Bottom-left of the bitmap relative to the pen position
+		int advance;
+	};
+
+	static const int FIRST_CHAR = 32;
+	static const int LAST_CHAR = 126;
+	static const int ATLAS_WIDTH = 256;
+
+	void appendText(std::vector<Vertex>& out, float x, float y, const char* text, float r, float g, float b) const;
+	bool rasterizeGlyphs(void* font, int cellWidth, int cellHeight, int columns, int rows, std::vector<GLubyte>& pixels);
+
+	Glyph glyphs[LAST_CHAR - FIRST_CHAR + 1];
+	std::vector<Vertex> vertices;
+	std::vector<GLubyte> atlas;
+	GLuint texture;
+	int fontHeight;
+};
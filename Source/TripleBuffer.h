@@ -0,0 +1,38 @@
+#pragma once
+
+#include <atomic>
+
+// Hands the latest value from one writing thread to one reading thread without locks.
+// Each side owns one of three slots and the third is traded with a single atomic
+// exchange, so the reader always sees a complete value and the writer never waits.
+// Values the reader was too slow for are overwritten, not queued.
+template <typename T>
+class TripleBuffer {
+public:
+	TripleBuffer() : shared(1), writing(0), reading(2) {}
+
+	// Writer: fills the slot completely, since it holds an older value, then publishes
+	// it. The slot changes with every publish.
+	T& writeSlot() { return slots[writing]; }
+	void publish() {
+		writing = shared.exchange(writing | FRESH, std::memory_order_acq_rel) & INDEX;
+	}
+
+	// Reader: takes the latest published value, returns false and keeps the current
+	// one when nothing was published since the last acquire
+	bool acquire() {
+		if (!(shared.load(std::memory_order_relaxed) & FRESH)) return false;
+		reading = shared.exchange(reading, std::memory_order_acq_rel) & INDEX;
+		return true;
+	}
+	const T& readSlot() const { return slots[reading]; }
+
+private:
+	static const unsigned int INDEX = 3;
+	static const unsigned int FRESH = 4;
+
+	T slots[3];
+	std::atomic<unsigned int> shared; // Index of the traded slot, with FRESH until the reader takes it
+	unsigned int writing;
+	unsigned int reading;
+};
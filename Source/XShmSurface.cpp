@@ -0,0 +1,226 @@
+#include "XShmSurface.h"
+#include <cstdio>
+#include <cstdlib>
+
+#ifdef HAVE_X11
+#include <X11/Xlib.h>
+#include <X11/Xutil.h>
+#include <GL/glx.h>
+#ifdef HAVE_XSHM
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#include <X11/extensions/XShm.h>
+#endif
+
+namespace {
+	// Bit position of an 8-bit channel mask, -1 for any other mask
+	int channelShift(unsigned long mask) {
+		for (int shift = 0; shift <= 24; shift += 8) {
+			if (mask == 0xffUL << shift) return shift;
+		}
+		return -1;
+	}
+
+#ifdef HAVE_XSHM
+	// XShmAttach fails asynchronously, e.g. for a server on another machine
+	bool attachFailed = false;
+
+	int catchAttachError(Display*, XErrorEvent*) {
+		attachFailed = true;
+		return 0;
+	}
+#endif
+}
+#endif
+
+XShmSurface::XShmSurface()
+	: display(NULL), window(0), visual(NULL), depth(0), gc(NULL), image(NULL), segment(NULL), shmAvailable(false),
+	  data(NULL), imageWidth(0), imageHeight(0), rowPixels(0) {
+	shifts[0] = shifts[1] = shifts[2] = 0;
+}
+
+XShmSurface::~XShmSurface() {
+	destroy();
+}
+
+#ifdef HAVE_X11
+bool XShmSurface::create(int width, int height) {
+	destroy();
+	Display* xDisplay = glXGetCurrentDisplay();
+	GLXDrawable drawable = glXGetCurrentDrawable();
+	if (!xDisplay || !drawable) {
+		info = "No current GLX window";
+		return false;
+	}
+
+	XWindowAttributes attributes;
+	if (!XGetWindowAttributes(xDisplay, drawable, &attributes)) {
+		info = "The GLX drawable is not a window";
+		return false;
+	}
+	Visual* xVisual = attributes.visual;
+	shifts[0] = channelShift(xVisual->red_mask);
+	shifts[1] = channelShift(xVisual->green_mask);
+	shifts[2] = channelShift(xVisual->blue_mask);
+	if (xVisual->c_class != TrueColor || shifts[0] < 0 || shifts[1] < 0 || shifts[2] < 0) {
+		info = "Needs a TrueColor visual with 8 bits per channel";
+		return false;
+	}
+
+	display = xDisplay;
+	window = drawable;
+	visual = xVisual;
+	depth = attributes.depth;
+	gc = XCreateGC(xDisplay, drawable, 0, NULL);
+#ifdef HAVE_XSHM
+	shmAvailable = XShmQueryExtension(xDisplay) != False;
+#endif
+	if (!createImage(width, height)) {
+		destroy();
+		return false;
+	}
+	return true;
+}
+
+bool XShmSurface::resize(int width, int height) {
+	if (!display) return false;
+	if (image && width == imageWidth && height == imageHeight) return true;
+	destroyImage();
+	return createImage(width, height);
+}
+
+bool XShmSurface::createImage(int width, int height) {
+	Display* xDisplay = (Display*)display;
+	width = width > 0 ? width : 1;
+	height = height > 0 ? height : 1;
+	XImage* xImage = NULL;
+
+#ifdef HAVE_XSHM
+	if (shmAvailable) {
+		XShmSegmentInfo* shm = new XShmSegmentInfo();
+		xImage = XShmCreateImage(xDisplay, (Visual*)visual, depth, ZPixmap, NULL, shm, width, height);
+		if (xImage && xImage->bits_per_pixel == 32) {
+			shm->shmid = shmget(IPC_PRIVATE, (size_t)xImage->bytes_per_line * height, IPC_CREAT | 0600);
+		} else {
+			shm->shmid = -1;
+		}
+		if (shm->shmid >= 0) {
+			shm->shmaddr = xImage->data = (char*)shmat(shm->shmid, NULL, 0);
+			shm->readOnly = False;
+			attachFailed = false;
+			XErrorHandler previous = XSetErrorHandler(catchAttachError);
+			bool attached = shm->shmaddr != (char*)-1 && XShmAttach(xDisplay, shm);
+			XSync(xDisplay, False);
+			XSetErrorHandler(previous);
+			// Removed now, the segment goes away once both sides have detached
+			shmctl(shm->shmid, IPC_RMID, NULL);
+			if (attached && !attachFailed) {
+				segment = shm;
+			} else {
+				if (shm->shmaddr != (char*)-1) shmdt(shm->shmaddr);
+				// Don't try again on every resize
+				shmAvailable = false;
+			}
+		}
+		if (!segment) {
+			if (xImage) {
+				xImage->data = NULL;
+				XDestroyImage(xImage);
+			}
+			xImage = NULL;
+			delete shm;
+		}
+	}
+#endif
+
+	if (!xImage) {
+		xImage = XCreateImage(xDisplay, (Visual*)visual, depth, ZPixmap, 0, NULL, width, height, 32, 0);
+		if (!xImage || xImage->bits_per_pixel != 32) {
+			if (xImage) XDestroyImage(xImage);
+			info = "Needs a visual with 32 bits per pixel";
+			return false;
+		}
+		// XDestroyImage frees this
+		xImage->data = (char*)malloc((size_t)xImage->bytes_per_line * height);
+		if (!xImage->data) {
+			XDestroyImage(xImage);
+			info = "Out of memory";
+			return false;
+		}
+	}
+
+	image = xImage;
+	data = (uint32_t*)xImage->data;
+	imageWidth = width;
+	imageHeight = height;
+	rowPixels = xImage->bytes_per_line / 4;
+	char text[128];
+	snprintf(text, sizeof(text), "%dx%d, depth %d, %s", width, height, depth,
+		segment ? "MIT-SHM" : "XPutImage (no shared memory)");
+	info = text;
+	return true;
+}
+
+void XShmSurface::destroyImage() {
+	XImage* xImage = (XImage*)image;
+	if (!xImage) return;
+#ifdef HAVE_XSHM
+	if (segment) {
+		XShmSegmentInfo* shm = (XShmSegmentInfo*)segment;
+		XShmDetach((Display*)display, shm);
+		XSync((Display*)display, False);
+		xImage->data = NULL;
+		XDestroyImage(xImage);
+		shmdt(shm->shmaddr);
+		delete shm;
+		segment = NULL;
+	} else
+#endif
+	{
+		XDestroyImage(xImage);
+	}
+	image = NULL;
+	data = NULL;
+	imageWidth = imageHeight = rowPixels = 0;
+}
+
+void XShmSurface::destroy() {
+	destroyImage();
+	if (gc) XFreeGC((Display*)display, (GC)gc);
+	gc = NULL;
+	display = NULL;
+	window = 0;
+	visual = NULL;
+	shmAvailable = false;
+}
+
+void XShmSurface::present() {
+	if (!image) return;
+	Display* xDisplay = (Display*)display;
+#ifdef HAVE_XSHM
+	if (segment) {
+		XShmPutImage(xDisplay, window, (GC)gc, (XImage*)image, 0, 0, 0, 0, imageWidth, imageHeight, False);
+	} else
+#endif
+	{
+		XPutImage(xDisplay, window, (GC)gc, (XImage*)image, 0, 0, 0, 0, imageWidth, imageHeight);
+	}
+	// The server reads shared pixels when it processes the request, not when it is sent
+	XSync(xDisplay, False);
+}
+#else
+bool XShmSurface::create(int, int) {
+	info = "Built without X11";
+	return false;
+}
+
+bool XShmSurface::resize(int, int) {
+	return false;
+}
+
+void XShmSurface::destroy() {
+}
+
+void XShmSurface::present() {
+}
+#endif
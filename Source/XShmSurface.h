@@ -0,0 +1,55 @@
+#pragma once
+
+#include <stdint.h>
+#include <string>
+
+// 32-bit pixels shown in the window of the current GLX context, for the software
+// renderer. The pixels live in a shared memory XImage (MIT-SHM), so presenting is one
+// XShmPutImage that the X server copies straight out of the segment. Displays without
+// the extension, such as remote ones, get a plain XImage sent over the socket instead.
+// Needs X11 (HAVE_X11); MIT-SHM is used when built with libXext (HAVE_XSHM).
+class XShmSurface {
+public:
+	XShmSurface();
+	~XShmSurface();
+
+	// Takes the display and window of the current GLX context. Needs a TrueColor
+	// visual with 8 bits per channel.
+	bool create(int width, int height);
+	// Reallocates the image for a new window size; the contents are undefined
+	bool resize(int width, int height);
+	void destroy();
+	// Copies the whole image into the window and waits until the server has read it,
+	// so drawing into the pixels can start again right away
+	void present();
+
+	bool active() const { return image != 0; }
+	uint32_t* pixels() const { return data; }
+	int width() const { return imageWidth; }
+	int height() const { return imageHeight; }
+	int stride() const { return rowPixels; } // Pixels from one row to the next, top row first
+	// Bit positions of the channels in a pixel
+	int redShift() const { return shifts[0]; }
+	int greenShift() const { return shifts[1]; }
+	int blueShift() const { return shifts[2]; }
+	bool sharedMemory() const { return segment != 0; }
+	// How the surface was created, or why it could not be
+	const std::string& description() const { return info; }
+
+private:
+	bool createImage(int width, int height);
+	void destroyImage();
+
+	void* display;        // Display*
+	unsigned long window; // Window
+	void* visual;         // Visual*
+	int depth;
+	void* gc;             // GC
+	void* image;          // XImage*
+	void* segment;        // XShmSegmentInfo*, when the image is shared
+	bool shmAvailable;
+	uint32_t* data;
+	int imageWidth, imageHeight, rowPixels;
+	int shifts[3];
+	std::string info;
+};
@@ -150,6 +150,7 @@
  */
 FGAPI void    FGAPIENTRY glutMainLoopEvent( void );
 FGAPI void    FGAPIENTRY glutLeaveMainLoop( void );
+FGAPI void    FGAPIENTRY glutWaitForEventsNs( unsigned long long timeout );
 FGAPI void    FGAPIENTRY glutExit         ( void );
 
 /*
@@ -158,11 +159,21 @@ FGAPI void    FGAPIENTRY glutExit         ( void );
 FGAPI void    FGAPIENTRY glutFullScreenToggle( void );
 FGAPI void    FGAPIENTRY glutLeaveFullScreen( void );
 
+/*
+ * Buffer swap control, see fg_display.c
+ */
+FGAPI int     FGAPIENTRY glutSwapInterval( int interval );
+
 /*
  * Menu functions
  */
 FGAPI void    FGAPIENTRY glutSetMenuFont( int menuID, void* font );
 
+/*
+ * Global callback functions, see fg_callbacks.c
+ */
+FGAPI void    FGAPIENTRY glutTimerFuncUs( unsigned int time, void (* callback)( int ), int value );
+
 /*
  * Window-specific callback functions, see fg_callbacks.c
  */
@@ -178,6 +189,8 @@ FGAPI void    FGAPIENTRY glutMenuDestroyFunc( void (* callback)( void ) );
  */
 FGAPI void    FGAPIENTRY glutSetOption ( GLenum option_flag, int value );
 FGAPI int *   FGAPIENTRY glutGetModeValues(GLenum mode, int * size);
+FGAPI unsigned long long FGAPIENTRY glutGetElapsedTimeNs( void );
+FGAPI unsigned long long FGAPIENTRY glutGetEventTimeNs( void );
 /* A.Donev: User-data manipulation */
 FGAPI void*   FGAPIENTRY glutGetWindowData( void );
 FGAPI void    FGAPIENTRY glutSetWindowData(void* data);
@@ -258,6 +271,7 @@ void    glutJoystickGetCenter( int ident, float *axes );
  */
 /* to get the typedef for va_list */
 #include <stdarg.h>
+FGAPI void    FGAPIENTRY glutInitHeadless( int* pargc, char** argv );
 FGAPI void    FGAPIENTRY glutInitContextVersion( int majorVersion, int minorVersion );
 FGAPI void    FGAPIENTRY glutInitContextFlags( int flags );
 FGAPI void    FGAPIENTRY glutInitContextProfile( int profile );
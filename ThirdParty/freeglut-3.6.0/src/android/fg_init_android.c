@@ -33,7 +33,7 @@ void fgPlatformInitialize()
   fghPlatformInitializeEGL();
 
   /* Get start time */
-  fgState.Time = fgSystemTime();
+  fgState.Time = fgSystemTimeNs();
 
   fgState.Initialised = GL_TRUE;
 }
@@ -149,18 +149,18 @@ static unsigned char key_ascii(struct android_app* app, AInputEvent* event) {
   return ascii;
 }
 
-unsigned long fgPlatformSystemTime ( void )
+fg_time_t fgPlatformSystemTimeNs ( void )
 {
   struct timeval now;
   gettimeofday( &now, NULL );
-  return now.tv_usec/1000 + now.tv_sec*1000;
+  return now.tv_usec*1000 + (fg_time_t)now.tv_sec*1000000000;
 }
 
 /*
  * Does the magic required to relinquish the CPU until something interesting
  * happens.
  */
-void fgPlatformSleepForEvents( fg_time_t msec )
+void fgPlatformSleepForEvents( fg_time_t nsec )
 {
     /* Android's NativeActivity relies on a Looper/ALooper object to
        notify about events.  The Looper object is plugged on two
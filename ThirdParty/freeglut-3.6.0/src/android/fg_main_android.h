@@ -30,8 +30,8 @@
 #include "fg_internal.h"
 
 extern void fgPlatformProcessSingleEvent(void);
-extern unsigned long fgPlatformSystemTime(void);
-extern void fgPlatformSleepForEvents(fg_time_t msec);
+extern fg_time_t fgPlatformSystemTimeNs(void);
+extern void fgPlatformSleepForEvents(fg_time_t nsec);
 extern void fgPlatformMainLoopPreliminaryWork(void);
 
 #endif
@@ -81,7 +81,7 @@ void fgPlatformInitialize()
     }
 
     /* Get start time */
-    fgState.Time = fgSystemTime();
+    fgState.Time = fgSystemTimeNs();
 
     fgState.Initialised = GL_TRUE;
 }
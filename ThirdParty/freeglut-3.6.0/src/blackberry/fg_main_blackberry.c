@@ -163,16 +163,16 @@ unsigned char key_ascii(int qnxKeycode)
 }
 
 //From fg_main_x11
-fg_time_t fgPlatformSystemTime ( void )
+fg_time_t fgPlatformSystemTimeNs ( void )
 {
 #ifdef CLOCK_MONOTONIC
     struct timespec now;
     clock_gettime(CLOCK_MONOTONIC, &now);
-    return now.tv_nsec/1000000 + now.tv_sec*1000;
+    return now.tv_nsec + (fg_time_t)now.tv_sec*1000000000;
 #elif defined(HAVE_GETTIMEOFDAY)
     struct timeval now;
     gettimeofday( &now, NULL );
-    return now.tv_usec/1000 + now.tv_sec*1000;
+    return now.tv_usec*1000 + (fg_time_t)now.tv_sec*1000000000;
 #endif
 }
 
@@ -180,10 +180,10 @@ fg_time_t fgPlatformSystemTime ( void )
  * Does the magic required to relinquish the CPU until something interesting
  * happens.
  */
-void fgPlatformSleepForEvents( fg_time_t msec )
+void fgPlatformSleepForEvents( fg_time_t nsec )
 {
     if(fgStructure.CurrentWindow && fgDisplay.pDisplay.event == NULL &&
-            bps_get_event(&fgDisplay.pDisplay.event, (int)msec) != BPS_SUCCESS) {
+            bps_get_event(&fgDisplay.pDisplay.event, (int)(nsec / 1000000)) != BPS_SUCCESS) {
         LOGW("BPS couldn't get event");
     }
 }
@@ -31,3 +31,9 @@ void fgPlatformGlutSwapBuffers( SFG_PlatformDisplay *pDisplayPtr, SFG_Window* Cu
   if (!eglSwapBuffers(pDisplayPtr->egl.Display, CurrentWindow->Window.pContext.egl.Surface))
     fgError("eglSwapBuffers: error %x\n", eglGetError());
 }
+
+int fgPlatformSwapInterval( SFG_PlatformDisplay *pDisplayPtr, SFG_Window* CurrentWindow, int interval )
+{
+  /* Applies to the surface bound to the current context, which is CurrentWindow's */
+  return eglSwapInterval(pDisplayPtr->egl.Display, interval) == EGL_TRUE;
+}
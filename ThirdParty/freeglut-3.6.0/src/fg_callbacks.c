@@ -44,12 +44,10 @@ void FGAPIENTRY glutIdleFuncUcall( FGCBIdleUC callback, FGCBUserData userData )
 
 IMPLEMENT_GLUT_CALLBACK_FUNC_ARG0(Idle)
 
-/* Creates a timer and sets its callback */
-void FGAPIENTRY glutTimerFuncUcall( unsigned int timeOut, FGCBTimerUC callback, int timerID, FGCBUserData userData )
+/* Creates a timer that fires after the given number of nanoseconds */
+static void fghAddTimer( fg_time_t timeOutNs, FGCBTimerUC callback, int timerID, FGCBUserData userData )
 {
-    SFG_Timer *timer, *node;
-
-    FREEGLUT_EXIT_IF_NOT_INITIALISED ( "glutTimerFuncUcall" );
+    SFG_Timer *timer;
 
     if( (timer = fgState.FreeTimers.Last) )
     {
@@ -65,16 +63,23 @@ void FGAPIENTRY glutTimerFuncUcall( unsigned int timeOut, FGCBTimerUC callback,
     timer->Callback     = callback;
     timer->CallbackData = userData;
     timer->ID           = timerID;
-    timer->TriggerTime  = fgElapsedTime() + timeOut;
+    timer->TriggerTime  = fgElapsedTimeNs() + timeOutNs;
 
-    /* Insert such that timers are sorted by end-time */
-    for( node = fgState.Timers.First; node; node = node->Node.Next )
-    {
-        if( node->TriggerTime > timer->TriggerTime )
-            break;
-    }
+    fgTimerHeapInsert( &fgState.Timers, timer );
+}
+
+/* Creates a timer and sets its callback */
+void FGAPIENTRY glutTimerFuncUcall( unsigned int timeOut, FGCBTimerUC callback, int timerID, FGCBUserData userData )
+{
+    FREEGLUT_EXIT_IF_NOT_INITIALISED ( "glutTimerFuncUcall" );
+    fghAddTimer( timeOut * (fg_time_t)1000000, callback, timerID, userData );
+}
 
-    fgListInsert( &fgState.Timers, node ? &node->Node : 0, &timer->Node );
+/* Same as glutTimerFuncUcall, with the timeout in microseconds */
+void FGAPIENTRY glutTimerFuncUsUcall( unsigned int timeOut, FGCBTimerUC callback, int timerID, FGCBUserData userData )
+{
+    FREEGLUT_EXIT_IF_NOT_INITIALISED ( "glutTimerFuncUsUcall" );
+    fghAddTimer( timeOut * (fg_time_t)1000, callback, timerID, userData );
 }
 
 IMPLEMENT_CALLBACK_FUNC_CB_ARG1(Timer, Timer)
@@ -91,6 +96,18 @@ void FGAPIENTRY glutTimerFunc( unsigned int timeOut, FGCBTimer callback, int tim
         glutTimerFuncUcall( timeOut, NULL, timerID, NULL );
 }
 
+void FGAPIENTRY glutTimerFuncUs( unsigned int timeOut, FGCBTimer callback, int timerID )
+{
+    FREEGLUT_EXIT_IF_NOT_INITIALISED ( "glutTimerFuncUs" );
+    if( callback )
+    {
+        FGCBTimer* reference = &callback;
+        glutTimerFuncUsUcall( timeOut, fghTimerFuncCallback, timerID, *((FGCBUserData*)reference) );
+    }
+    else
+        glutTimerFuncUsUcall( timeOut, NULL, timerID, NULL );
+}
+
 /* Deprecated version of glutMenuStatusFunc callback setting method */
 void FGAPIENTRY glutMenuStateFunc( FGCBMenuState callback )
 {
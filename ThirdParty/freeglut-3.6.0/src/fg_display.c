@@ -31,6 +31,7 @@
 
 /* Function prototypes */
 extern void fgPlatformGlutSwapBuffers( SFG_PlatformDisplay *pDisplayPtr, SFG_Window* CurrentWindow );
+extern int fgPlatformSwapInterval( SFG_PlatformDisplay *pDisplayPtr, SFG_Window* CurrentWindow, int interval );
 
 
 /* -- INTERFACE FUNCTIONS -------------------------------------------------- */
@@ -88,6 +89,20 @@ void FGAPIENTRY glutSwapBuffers( void )
     }
 }
 
+/*
+ * Sets the number of video frames the current window waits between buffer
+ * swaps: 0 disables vertical sync, 1 swaps once per refresh. Returns GL_TRUE
+ * if the platform supports the requested interval.
+ */
+int FGAPIENTRY glutSwapInterval( int interval )
+{
+    FREEGLUT_EXIT_IF_NOT_INITIALISED ( "glutSwapInterval" );
+    FREEGLUT_EXIT_IF_NO_WINDOW ( "glutSwapInterval" );
+    freeglut_return_val_if_fail( interval >= 0, GL_FALSE );
+
+    return fgPlatformSwapInterval( &fgDisplay.pDisplay, fgStructure.CurrentWindow, interval );
+}
+
 /*
  * Mark appropriate window to be displayed
  */
@@ -169,14 +169,19 @@ static GLUTproc fghGetGLUTProcAddress( const char* procName )
     /* freeglut extensions */
     CHECK_NAME(glutMainLoopEvent);
     CHECK_NAME(glutLeaveMainLoop);
+    CHECK_NAME(glutWaitForEventsNs);
     CHECK_NAME(glutCloseFunc);
     CHECK_NAME(glutWMCloseFunc);
     CHECK_NAME(glutMenuDestroyFunc);
     CHECK_NAME(glutFullScreenToggle);
     CHECK_NAME(glutLeaveFullScreen);
+    CHECK_NAME(glutSwapInterval);
     CHECK_NAME(glutSetMenuFont);
+    CHECK_NAME(glutTimerFuncUs);
     CHECK_NAME(glutSetOption);
     CHECK_NAME(glutGetModeValues);
+    CHECK_NAME(glutGetElapsedTimeNs);
+    CHECK_NAME(glutGetEventTimeNs);
     CHECK_NAME(glutSetWindowData);
     CHECK_NAME(glutGetWindowData);
     CHECK_NAME(glutSetMenuData);
@@ -200,6 +205,7 @@ static GLUTproc fghGetGLUTProcAddress( const char* procName )
     CHECK_NAME(glutJoystickGetMinRange);
     CHECK_NAME(glutJoystickGetMaxRange);
     CHECK_NAME(glutJoystickGetCenter);
+    CHECK_NAME(glutInitHeadless);
     CHECK_NAME(glutInitContextVersion);
     CHECK_NAME(glutInitContextFlags);
     CHECK_NAME(glutInitContextProfile);
@@ -214,6 +220,7 @@ static GLUTproc fghGetGLUTProcAddress( const char* procName )
     /* freeglut user callback functions */
     CHECK_NAME(glutCreateMenuUcall);
     CHECK_NAME(glutTimerFuncUcall);
+    CHECK_NAME(glutTimerFuncUsUcall);
     CHECK_NAME(glutIdleFuncUcall);
     CHECK_NAME(glutKeyboardFuncUcall);
     CHECK_NAME(glutSpecialFuncUcall);
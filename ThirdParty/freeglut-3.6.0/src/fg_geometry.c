@@ -60,10 +60,20 @@ static void fghDrawGeometrySolid11(GLfloat *vertices, GLfloat *normals, GLfloat
 static void fghDrawGeometryWire20(GLfloat *vertices, GLfloat *normals, GLsizei numVertices,
                                   GLushort *vertIdxs, GLsizei numParts, GLsizei numVertPerPart, GLenum vertexMode,
                                   GLushort *vertIdxs2, GLsizei numParts2, GLsizei numVertPerPart2,
-                                  GLint attribute_v_coord, GLint attribute_v_normal);
+                                  GLint attribute_v_coord, GLint attribute_v_normal, GLuint *buffers);
 static void fghDrawGeometrySolid20(GLfloat *vertices, GLfloat *normals, GLfloat *textcs, GLsizei numVertices,
                                    GLushort *vertIdxs, GLsizei numParts, GLsizei numVertIdxsPerPart,
-                                   GLint attribute_v_coord, GLint attribute_v_normal, GLint attribute_v_texture);
+                                   GLint attribute_v_coord, GLint attribute_v_normal, GLint attribute_v_texture,
+                                   GLuint *buffers);
+/* Slots of the buffer objects kept for a shape drawn through OpenGL 2.0, see
+   fghDrawGeometryWire20 and fghDrawGeometrySolid20. A zero name is created on
+   first use. */
+#define FGH_VBO_COORDS      0
+#define FGH_VBO_NORMALS     1
+#define FGH_IBO_ELEMENTS    2
+#define FGH_IBO_ELEMENTS2   3
+#define FGH_NUM_BUFFERS     4
+
 /* declare function for generating visualization of normals */
 static void fghGenerateNormalVisualization(GLfloat *vertices, GLfloat *normals, GLsizei numVertices);
 static void fghDrawNormalVisualization11(void);
@@ -132,13 +142,17 @@ static void fghDrawNormalVisualization20(GLint attribute_v_coord);
  * GLushort *vertIdxs2, GLsizei numParts2, GLsizei numVertPerPart2
  *   non-polyhedra only: same as the above, but now for subdivisions along
  *   the other axis. Always drawn as GL_LINE_LOOP.
+ * GLuint *buffers
+ *   FGH_NUM_BUFFERS buffer object names kept by the caller for the OpenGL
+ *   2.0 path, zero ones are created and filled. NULL to upload the arrays
+ *   for this draw only.
  *
  * Feel free to contribute better naming ;)
  */
-void fghDrawGeometryWire(GLfloat *vertices, GLfloat *normals, GLsizei numVertices,
-                                GLushort *vertIdxs, GLsizei numParts, GLsizei numVertPerPart, GLenum vertexMode,
-                                GLushort *vertIdxs2, GLsizei numParts2, GLsizei numVertPerPart2
-    )
+static void fghDrawGeometryWireBuffered(GLfloat *vertices, GLfloat *normals, GLsizei numVertices,
+                                        GLushort *vertIdxs, GLsizei numParts, GLsizei numVertPerPart, GLenum vertexMode,
+                                        GLushort *vertIdxs2, GLsizei numParts2, GLsizei numVertPerPart2,
+                                        GLuint *buffers)
 {
     SFG_Window *win = fgStructure.CurrentWindow;
 
@@ -150,13 +164,23 @@ void fghDrawGeometryWire(GLfloat *vertices, GLfloat *normals, GLsizei numVertice
         fghDrawGeometryWire20(vertices, normals, numVertices,
                               vertIdxs, numParts, numVertPerPart, vertexMode,
                               vertIdxs2, numParts2, numVertPerPart2,
-                              attribute_v_coord, attribute_v_normal);
+                              attribute_v_coord, attribute_v_normal, buffers);
     else
         fghDrawGeometryWire11(vertices, normals,
                               vertIdxs, numParts, numVertPerPart, vertexMode,
                               vertIdxs2, numParts2, numVertPerPart2);
 }
 
+void fghDrawGeometryWire(GLfloat *vertices, GLfloat *normals, GLsizei numVertices,
+                                GLushort *vertIdxs, GLsizei numParts, GLsizei numVertPerPart, GLenum vertexMode,
+                                GLushort *vertIdxs2, GLsizei numParts2, GLsizei numVertPerPart2
+    )
+{
+    fghDrawGeometryWireBuffered(vertices, normals, numVertices,
+                                vertIdxs, numParts, numVertPerPart, vertexMode,
+                                vertIdxs2, numParts2, numVertPerPart2, NULL);
+}
+
 /* Draw the geometric shape with filled triangles
  *
  * Arguments:
@@ -182,9 +206,12 @@ void fghDrawGeometryWire(GLfloat *vertices, GLfloat *normals, GLsizei numVertice
        processed at each draw call.
  *   numParts * numVertPerPart gives the number of entries in the vertex
  *     array vertIdxs
+ * GLuint *buffers
+ *   as for fghDrawGeometryWireBuffered, texture coordinates are never kept
  */
-void fghDrawGeometrySolid(GLfloat *vertices, GLfloat *normals, GLfloat *textcs, GLsizei numVertices,
-                          GLushort *vertIdxs, GLsizei numParts, GLsizei numVertIdxsPerPart)
+static void fghDrawGeometrySolidBuffered(GLfloat *vertices, GLfloat *normals, GLfloat *textcs, GLsizei numVertices,
+                                         GLushort *vertIdxs, GLsizei numParts, GLsizei numVertIdxsPerPart,
+                                         GLuint *buffers)
 {
     GLint attribute_v_coord, attribute_v_normal, attribute_v_texture;
     SFG_Window *win = fgStructure.CurrentWindow;
@@ -205,7 +232,8 @@ void fghDrawGeometrySolid(GLfloat *vertices, GLfloat *normals, GLfloat *textcs,
         /* User requested a 2.0 draw */
         fghDrawGeometrySolid20(vertices, normals, textcs, numVertices,
                                vertIdxs, numParts, numVertIdxsPerPart,
-                               attribute_v_coord, attribute_v_normal, attribute_v_texture);
+                               attribute_v_coord, attribute_v_normal, attribute_v_texture,
+                               buffers);
 
         if (win && win->State.VisualizeNormals)
             /* draw normals for each vertex as well */
@@ -222,6 +250,13 @@ void fghDrawGeometrySolid(GLfloat *vertices, GLfloat *normals, GLfloat *textcs,
     }
 }
 
+void fghDrawGeometrySolid(GLfloat *vertices, GLfloat *normals, GLfloat *textcs, GLsizei numVertices,
+                          GLushort *vertIdxs, GLsizei numParts, GLsizei numVertIdxsPerPart)
+{
+    fghDrawGeometrySolidBuffered(vertices, normals, textcs, numVertices,
+                                 vertIdxs, numParts, numVertIdxsPerPart, NULL);
+}
+
 #ifndef GL_VERSION_1_1
 static void fghDrawGeometryWire10(GLfloat *varr, GLfloat *narr, GLushort *iarr,
 		GLsizei nparts, GLsizei npartverts, GLenum prim, GLushort *iarr2,
@@ -402,7 +437,7 @@ static void fghDrawGeometrySolid11(GLfloat *vertices, GLfloat *normals, GLfloat
 static void fghDrawGeometryWire20(GLfloat *vertices, GLfloat *normals, GLsizei numVertices,
                                   GLushort *vertIdxs, GLsizei numParts, GLsizei numVertPerPart, GLenum vertexMode,
                                   GLushort *vertIdxs2, GLsizei numParts2, GLsizei numVertPerPart2,
-                                  GLint attribute_v_coord, GLint attribute_v_normal)
+                                  GLint attribute_v_coord, GLint attribute_v_normal, GLuint *buffers)
 {
 #if defined(GL_VERSION_1_1) || defined(GL_VERSION_ES_CM_1_0)
     GLuint vbo_coords = 0, vbo_normals = 0,
@@ -412,33 +447,49 @@ static void fghDrawGeometryWire20(GLfloat *vertices, GLfloat *normals, GLsizei n
     int i;
 
     if (numVertices > 0 && attribute_v_coord != -1) {
-        fghGenBuffers(1, &vbo_coords);
-        fghBindBuffer(FGH_ARRAY_BUFFER, vbo_coords);
-        fghBufferData(FGH_ARRAY_BUFFER, numVertices * 3 * sizeof(vertices[0]),
-                      vertices, FGH_STATIC_DRAW);
+        if (buffers && buffers[FGH_VBO_COORDS])
+            vbo_coords = buffers[FGH_VBO_COORDS];
+        else {
+            fghGenBuffers(1, &vbo_coords);
+            fghBindBuffer(FGH_ARRAY_BUFFER, vbo_coords);
+            fghBufferData(FGH_ARRAY_BUFFER, numVertices * 3 * sizeof(vertices[0]),
+                          vertices, FGH_STATIC_DRAW);
+        }
     }
 
     if (numVertices > 0 && attribute_v_normal != -1) {
-        fghGenBuffers(1, &vbo_normals);
-        fghBindBuffer(FGH_ARRAY_BUFFER, vbo_normals);
-        fghBufferData(FGH_ARRAY_BUFFER, numVertices * 3 * sizeof(normals[0]),
-                      normals, FGH_STATIC_DRAW);
+        if (buffers && buffers[FGH_VBO_NORMALS])
+            vbo_normals = buffers[FGH_VBO_NORMALS];
+        else {
+            fghGenBuffers(1, &vbo_normals);
+            fghBindBuffer(FGH_ARRAY_BUFFER, vbo_normals);
+            fghBufferData(FGH_ARRAY_BUFFER, numVertices * 3 * sizeof(normals[0]),
+                          normals, FGH_STATIC_DRAW);
+        }
     }
 
     if (vertIdxs != NULL) {
-        fghGenBuffers(1, &ibo_elements);
-        fghBindBuffer(FGH_ELEMENT_ARRAY_BUFFER, ibo_elements);
-        fghBufferData(FGH_ELEMENT_ARRAY_BUFFER, numVertIdxs * sizeof(vertIdxs[0]),
-                      vertIdxs, FGH_STATIC_DRAW);
-        fghBindBuffer(FGH_ELEMENT_ARRAY_BUFFER, 0);
+        if (buffers && buffers[FGH_IBO_ELEMENTS])
+            ibo_elements = buffers[FGH_IBO_ELEMENTS];
+        else {
+            fghGenBuffers(1, &ibo_elements);
+            fghBindBuffer(FGH_ELEMENT_ARRAY_BUFFER, ibo_elements);
+            fghBufferData(FGH_ELEMENT_ARRAY_BUFFER, numVertIdxs * sizeof(vertIdxs[0]),
+                          vertIdxs, FGH_STATIC_DRAW);
+            fghBindBuffer(FGH_ELEMENT_ARRAY_BUFFER, 0);
+        }
     }
 
     if (vertIdxs2 != NULL) {
-        fghGenBuffers(1, &ibo_elements2);
-        fghBindBuffer(FGH_ELEMENT_ARRAY_BUFFER, ibo_elements2);
-        fghBufferData(FGH_ELEMENT_ARRAY_BUFFER, numVertIdxs2 * sizeof(vertIdxs2[0]),
-                      vertIdxs2, FGH_STATIC_DRAW);
-        fghBindBuffer(FGH_ELEMENT_ARRAY_BUFFER, 0);
+        if (buffers && buffers[FGH_IBO_ELEMENTS2])
+            ibo_elements2 = buffers[FGH_IBO_ELEMENTS2];
+        else {
+            fghGenBuffers(1, &ibo_elements2);
+            fghBindBuffer(FGH_ELEMENT_ARRAY_BUFFER, ibo_elements2);
+            fghBufferData(FGH_ELEMENT_ARRAY_BUFFER, numVertIdxs2 * sizeof(vertIdxs2[0]),
+                          vertIdxs2, FGH_STATIC_DRAW);
+            fghBindBuffer(FGH_ELEMENT_ARRAY_BUFFER, 0);
+        }
     }
 
     if (vbo_coords) {
@@ -498,14 +549,29 @@ static void fghDrawGeometryWire20(GLfloat *vertices, GLfloat *normals, GLsizei n
     if (vbo_normals != 0)
         fghDisableVertexAttribArray(attribute_v_normal);
 
-    if (vbo_coords != 0)
-        fghDeleteBuffers(1, &vbo_coords);
-    if (vbo_normals != 0)
-        fghDeleteBuffers(1, &vbo_normals);
-    if (ibo_elements != 0)
-        fghDeleteBuffers(1, &ibo_elements);
-    if (ibo_elements2 != 0)
-        fghDeleteBuffers(1, &ibo_elements2);
+    if (buffers)
+    {
+        /* Keep them for the next draw of the same shape */
+        if (vbo_coords)
+            buffers[FGH_VBO_COORDS] = vbo_coords;
+        if (vbo_normals)
+            buffers[FGH_VBO_NORMALS] = vbo_normals;
+        if (ibo_elements)
+            buffers[FGH_IBO_ELEMENTS] = ibo_elements;
+        if (ibo_elements2)
+            buffers[FGH_IBO_ELEMENTS2] = ibo_elements2;
+    }
+    else
+    {
+        if (vbo_coords != 0)
+            fghDeleteBuffers(1, &vbo_coords);
+        if (vbo_normals != 0)
+            fghDeleteBuffers(1, &vbo_normals);
+        if (ibo_elements != 0)
+            fghDeleteBuffers(1, &ibo_elements);
+        if (ibo_elements2 != 0)
+            fghDeleteBuffers(1, &ibo_elements2);
+    }
 #endif	/* GL version at least 1.1 */
 }
 
@@ -515,7 +581,8 @@ static void fghDrawGeometryWire20(GLfloat *vertices, GLfloat *normals, GLsizei n
 /* Version for OpenGL (ES) >= 2.0 */
 static void fghDrawGeometrySolid20(GLfloat *vertices, GLfloat *normals, GLfloat *textcs, GLsizei numVertices,
                                    GLushort *vertIdxs, GLsizei numParts, GLsizei numVertIdxsPerPart,
-                                   GLint attribute_v_coord, GLint attribute_v_normal, GLint attribute_v_texture)
+                                   GLint attribute_v_coord, GLint attribute_v_normal, GLint attribute_v_texture,
+                                   GLuint *buffers)
 {
 #if defined(GL_VERSION_1_1) || defined(GL_VERSION_ES_CM_1_0)
     GLuint vbo_coords = 0, vbo_normals = 0, vbo_textcs = 0, ibo_elements = 0;
@@ -523,19 +590,27 @@ static void fghDrawGeometrySolid20(GLfloat *vertices, GLfloat *normals, GLfloat
     int i;
 
     if (numVertices > 0 && attribute_v_coord != -1) {
-        fghGenBuffers(1, &vbo_coords);
-        fghBindBuffer(FGH_ARRAY_BUFFER, vbo_coords);
-        fghBufferData(FGH_ARRAY_BUFFER, numVertices * 3 * sizeof(vertices[0]),
-                      vertices, FGH_STATIC_DRAW);
-        fghBindBuffer(FGH_ARRAY_BUFFER, 0);
+        if (buffers && buffers[FGH_VBO_COORDS])
+            vbo_coords = buffers[FGH_VBO_COORDS];
+        else {
+            fghGenBuffers(1, &vbo_coords);
+            fghBindBuffer(FGH_ARRAY_BUFFER, vbo_coords);
+            fghBufferData(FGH_ARRAY_BUFFER, numVertices * 3 * sizeof(vertices[0]),
+                          vertices, FGH_STATIC_DRAW);
+            fghBindBuffer(FGH_ARRAY_BUFFER, 0);
+        }
     }
 
     if (numVertices > 0 && attribute_v_normal != -1) {
-        fghGenBuffers(1, &vbo_normals);
-        fghBindBuffer(FGH_ARRAY_BUFFER, vbo_normals);
-        fghBufferData(FGH_ARRAY_BUFFER, numVertices * 3 * sizeof(normals[0]),
-                      normals, FGH_STATIC_DRAW);
-        fghBindBuffer(FGH_ARRAY_BUFFER, 0);
+        if (buffers && buffers[FGH_VBO_NORMALS])
+            vbo_normals = buffers[FGH_VBO_NORMALS];
+        else {
+            fghGenBuffers(1, &vbo_normals);
+            fghBindBuffer(FGH_ARRAY_BUFFER, vbo_normals);
+            fghBufferData(FGH_ARRAY_BUFFER, numVertices * 3 * sizeof(normals[0]),
+                          normals, FGH_STATIC_DRAW);
+            fghBindBuffer(FGH_ARRAY_BUFFER, 0);
+        }
     }
 
     if (numVertices > 0 && attribute_v_texture != -1 && textcs) {
@@ -547,11 +622,15 @@ static void fghDrawGeometrySolid20(GLfloat *vertices, GLfloat *normals, GLfloat
     }
 
     if (vertIdxs != NULL) {
-        fghGenBuffers(1, &ibo_elements);
-        fghBindBuffer(FGH_ELEMENT_ARRAY_BUFFER, ibo_elements);
-        fghBufferData(FGH_ELEMENT_ARRAY_BUFFER, numVertIdxs * sizeof(vertIdxs[0]),
-                      vertIdxs, FGH_STATIC_DRAW);
-        fghBindBuffer(FGH_ELEMENT_ARRAY_BUFFER, 0);
+        if (buffers && buffers[FGH_IBO_ELEMENTS])
+            ibo_elements = buffers[FGH_IBO_ELEMENTS];
+        else {
+            fghGenBuffers(1, &ibo_elements);
+            fghBindBuffer(FGH_ELEMENT_ARRAY_BUFFER, ibo_elements);
+            fghBufferData(FGH_ELEMENT_ARRAY_BUFFER, numVertIdxs * sizeof(vertIdxs[0]),
+                          vertIdxs, FGH_STATIC_DRAW);
+            fghBindBuffer(FGH_ELEMENT_ARRAY_BUFFER, 0);
+        }
     }
 
     if (vbo_coords) {
@@ -619,14 +698,27 @@ static void fghDrawGeometrySolid20(GLfloat *vertices, GLfloat *normals, GLfloat
     if (vbo_textcs != 0)
         fghDisableVertexAttribArray(attribute_v_texture);
 
-    if (vbo_coords != 0)
-        fghDeleteBuffers(1, &vbo_coords);
-    if (vbo_normals != 0)
-        fghDeleteBuffers(1, &vbo_normals);
     if (vbo_textcs != 0)
         fghDeleteBuffers(1, &vbo_textcs);
-    if (ibo_elements != 0)
-        fghDeleteBuffers(1, &ibo_elements);
+    if (buffers)
+    {
+        /* Keep them for the next draw of the same shape */
+        if (vbo_coords)
+            buffers[FGH_VBO_COORDS] = vbo_coords;
+        if (vbo_normals)
+            buffers[FGH_VBO_NORMALS] = vbo_normals;
+        if (ibo_elements)
+            buffers[FGH_IBO_ELEMENTS] = ibo_elements;
+    }
+    else
+    {
+        if (vbo_coords != 0)
+            fghDeleteBuffers(1, &vbo_coords);
+        if (vbo_normals != 0)
+            fghDeleteBuffers(1, &vbo_normals);
+        if (ibo_elements != 0)
+            fghDeleteBuffers(1, &ibo_elements);
+    }
 #endif	/* GL version at least 1.1 */
 }
 
@@ -1758,10 +1850,213 @@ static void fghSierpinskiSponge ( int numLevels, double offset[3], GLfloat scale
 }
 
 
+/* -- SHAPE CACHE ------------------------------------------------------ */
+/*
+ * The round shapes are generated from their parameters. The generated
+ * arrays are kept, together with the buffer objects they were uploaded to on
+ * the OpenGL 2.0 path, so that drawing the same shape again only costs the
+ * draw calls. Buffer objects belong to the context of the window they were
+ * created in, which is part of the key. When the cache is full the least
+ * recently drawn shape is evicted.
+ */
+#define FGH_SHAPE_CACHE_SIZE 64
+
+typedef enum
+{
+    FGH_SHAPE_SPHERE,
+    FGH_SHAPE_CONE,
+    FGH_SHAPE_CYLINDER,
+    FGH_SHAPE_TORUS
+} fghShapeType;
+
+typedef struct tagSFG_ShapeCacheEntry SFG_ShapeCacheEntry;
+struct tagSFG_ShapeCacheEntry
+{
+    SFG_Node     Node;          /* most recently drawn first                */
+
+    /* Key */
+    SFG_Window  *Window;        /* whose context owns Buffers               */
+    fghShapeType Type;
+    GLboolean    WireMode;
+    GLfloat      Size1, Size2;  /* radius/base, height, or torus radii      */
+    GLint        Div1, Div2;    /* slices and stacks, or sides and rings    */
+
+    /* Geometry, as passed to fghDrawGeometryWire/Solid */
+    GLfloat     *Vertices, *Normals;
+    GLsizei      NumVertices;
+    GLushort    *VertIdxs;
+    GLsizei      NumParts, NumVertPerPart;
+    GLenum       VertexMode;    /* wire mode only                           */
+    GLushort    *VertIdxs2;     /* wire mode only                           */
+    GLsizei      NumParts2, NumVertPerPart2;
+
+    GLuint       Buffers[FGH_NUM_BUFFERS];
+};
+
+static SFG_List fghShapeCache;
+static int      fghShapeCacheCount;
+
+static void fghShapeCacheEvict( SFG_ShapeCacheEntry *entry )
+{
+#if defined(GL_VERSION_1_1) || defined(GL_VERSION_ES_CM_1_0)
+    int i;
+
+    for( i = 0; i < FGH_NUM_BUFFERS; i++ )
+        if( entry->Buffers[ i ] )
+            break;
+
+    if( i < FGH_NUM_BUFFERS )
+    {
+        SFG_Window *current = fgStructure.CurrentWindow;
+
+        if( current != entry->Window )
+            fgSetWindow( entry->Window );
+        fghDeleteBuffers( FGH_NUM_BUFFERS, entry->Buffers );
+        if( current != entry->Window )
+            fgSetWindow( current );
+    }
+#endif
+
+    fgListRemove( &fghShapeCache, &entry->Node );
+    fghShapeCacheCount--;
+
+    free( entry->Vertices );
+    free( entry->Normals );
+    free( entry->VertIdxs );
+    free( entry->VertIdxs2 );
+    free( entry );
+}
+
+/*
+ * Finds a cached shape for the current window and moves it to the front,
+ * or returns NULL
+ */
+static SFG_ShapeCacheEntry *fghShapeCacheFind( fghShapeType type, GLboolean useWireMode,
+                                               GLfloat size1, GLfloat size2, GLint div1, GLint div2 )
+{
+    SFG_ShapeCacheEntry *entry;
+
+    for( entry = ( SFG_ShapeCacheEntry * )fghShapeCache.First; entry;
+         entry = ( SFG_ShapeCacheEntry * )entry->Node.Next )
+    {
+        if( entry->Window == fgStructure.CurrentWindow &&
+            entry->Type == type && entry->WireMode == useWireMode &&
+            entry->Size1 == size1 && entry->Size2 == size2 &&
+            entry->Div1 == div1 && entry->Div2 == div2 )
+        {
+            if( fghShapeCache.First != &entry->Node )
+            {
+                fgListRemove( &fghShapeCache, &entry->Node );
+                fgListInsert( &fghShapeCache, fghShapeCache.First, &entry->Node );
+            }
+            return entry;
+        }
+    }
+
+    return NULL;
+}
+
+/*
+ * Adds a new shape for the current window at the front, evicting the least
+ * recently drawn one if the cache is full. The entry takes over the arrays
+ * and frees them when it is evicted; the caller fills in the geometry.
+ */
+static SFG_ShapeCacheEntry *fghShapeCacheAdd( fghShapeType type, GLboolean useWireMode,
+                                              GLfloat size1, GLfloat size2, GLint div1, GLint div2 )
+{
+    SFG_ShapeCacheEntry *entry;
+
+    if( fghShapeCacheCount >= FGH_SHAPE_CACHE_SIZE )
+        fghShapeCacheEvict( ( SFG_ShapeCacheEntry * )fghShapeCache.Last );
+
+    entry = calloc( 1, sizeof( SFG_ShapeCacheEntry ) );
+    if( !entry )
+        fgError( "Failed to allocate memory in fghShapeCacheAdd" );
+
+    entry->Window   = fgStructure.CurrentWindow;
+    entry->Type     = type;
+    entry->WireMode = useWireMode;
+    entry->Size1    = size1;
+    entry->Size2    = size2;
+    entry->Div1     = div1;
+    entry->Div2     = div2;
+
+    fgListInsert( &fghShapeCache, fghShapeCache.First, &entry->Node );
+    fghShapeCacheCount++;
+    return entry;
+}
+
+/* Hands the generated arrays and how to draw them to a new entry */
+static void fghShapeCacheStoreWire( SFG_ShapeCacheEntry *entry,
+                                    GLfloat *vertices, GLfloat *normals, GLsizei numVertices,
+                                    GLushort *vertIdxs, GLsizei numParts, GLsizei numVertPerPart, GLenum vertexMode,
+                                    GLushort *vertIdxs2, GLsizei numParts2, GLsizei numVertPerPart2 )
+{
+    entry->Vertices        = vertices;
+    entry->Normals         = normals;
+    entry->NumVertices     = numVertices;
+    entry->VertIdxs        = vertIdxs;
+    entry->NumParts        = numParts;
+    entry->NumVertPerPart  = numVertPerPart;
+    entry->VertexMode      = vertexMode;
+    entry->VertIdxs2       = vertIdxs2;
+    entry->NumParts2       = numParts2;
+    entry->NumVertPerPart2 = numVertPerPart2;
+}
+
+static void fghShapeCacheStoreSolid( SFG_ShapeCacheEntry *entry,
+                                     GLfloat *vertices, GLfloat *normals, GLsizei numVertices,
+                                     GLushort *vertIdxs, GLsizei numParts, GLsizei numVertIdxsPerPart )
+{
+    fghShapeCacheStoreWire( entry, vertices, normals, numVertices,
+                            vertIdxs, numParts, numVertIdxsPerPart, GL_TRIANGLE_STRIP,
+                            NULL, 0, 0 );
+}
+
+static void fghShapeCacheDraw( SFG_ShapeCacheEntry *entry )
+{
+    if( entry->WireMode )
+        fghDrawGeometryWireBuffered( entry->Vertices, entry->Normals, entry->NumVertices,
+                                     entry->VertIdxs, entry->NumParts, entry->NumVertPerPart, entry->VertexMode,
+                                     entry->VertIdxs2, entry->NumParts2, entry->NumVertPerPart2,
+                                     entry->Buffers );
+    else
+        fghDrawGeometrySolidBuffered( entry->Vertices, entry->Normals, NULL, entry->NumVertices,
+                                      entry->VertIdxs, entry->NumParts, entry->NumVertPerPart,
+                                      entry->Buffers );
+}
+
+/*
+ * Drops the shapes cached for a window, while its context still exists.
+ * NULL drops the ones drawn without a current window.
+ */
+void fgShapeCacheRelease( SFG_Window *window )
+{
+    SFG_ShapeCacheEntry *entry = ( SFG_ShapeCacheEntry * )fghShapeCache.First;
+
+    while( entry )
+    {
+        SFG_ShapeCacheEntry *next = ( SFG_ShapeCacheEntry * )entry->Node.Next;
+
+        if( entry->Window == window )
+            fghShapeCacheEvict( entry );
+        entry = next;
+    }
+}
+
+
 static void fghSphere( GLfloat radius, GLint slices, GLint stacks, GLboolean useWireMode )
 {
     int i,j,idx, nVert;
     GLfloat *vertices, *normals;
+    SFG_ShapeCacheEntry *shape;
+
+    shape = fghShapeCacheFind( FGH_SHAPE_SPHERE, useWireMode, radius, 0.0f, slices, stacks );
+    if( shape )
+    {
+        fghShapeCacheDraw( shape );
+        return;
+    }
 
     /* Generate vertices and normals */
     fghGenerateSphere(radius,slices,stacks,&vertices,&normals,&nVert);
@@ -1770,6 +2065,8 @@ static void fghSphere( GLfloat radius, GLint slices, GLint stacks, GLboolean use
         /* nothing to draw */
         return;
 
+    shape = fghShapeCacheAdd( FGH_SHAPE_SPHERE, useWireMode, radius, 0.0f, slices, stacks );
+
     if (useWireMode)
     {
         GLushort  *sliceIdx, *stackIdx;
@@ -1809,14 +2106,10 @@ static void fghSphere( GLfloat radius, GLint slices, GLint stacks, GLboolean use
             sliceIdx[idx++] = nVert-1;              /* zero based index, last element in array... */
         }
 
-        /* draw */
-        fghDrawGeometryWire(vertices,normals,nVert,
+        /* the cache owns the arrays from here on */
+        fghShapeCacheStoreWire(shape,vertices,normals,nVert,
             sliceIdx,slices,stacks+1,GL_LINE_STRIP,
             stackIdx,stacks-1,slices);
-
-        /* cleanup allocated memory */
-        free(sliceIdx);
-        free(stackIdx);
     }
     else
     {
@@ -1871,22 +2164,25 @@ static void fghSphere( GLfloat radius, GLint slices, GLint stacks, GLboolean use
         stripIdx[idx+1] = offset;
 
 
-        /* draw */
-        fghDrawGeometrySolid(vertices,normals,NULL,nVert,stripIdx,stacks,(slices+1)*2);
-
-        /* cleanup allocated memory */
-        free(stripIdx);
+        /* the cache owns the arrays from here on */
+        fghShapeCacheStoreSolid(shape,vertices,normals,nVert,stripIdx,stacks,(slices+1)*2);
     }
 
-    /* cleanup allocated memory */
-    free(vertices);
-    free(normals);
+    fghShapeCacheDraw( shape );
 }
 
 static void fghCone( GLfloat base, GLfloat height, GLint slices, GLint stacks, GLboolean useWireMode )
 {
     int i,j,idx, nVert;
     GLfloat *vertices, *normals;
+    SFG_ShapeCacheEntry *shape;
+
+    shape = fghShapeCacheFind( FGH_SHAPE_CONE, useWireMode, base, height, slices, stacks );
+    if( shape )
+    {
+        fghShapeCacheDraw( shape );
+        return;
+    }
 
     /* Generate vertices and normals */
     /* Note, (stacks+1)*slices vertices for side of object, slices+1 for top and bottom closures */
@@ -1896,6 +2192,8 @@ static void fghCone( GLfloat base, GLfloat height, GLint slices, GLint stacks, G
         /* nothing to draw */
         return;
 
+    shape = fghShapeCacheAdd( FGH_SHAPE_CONE, useWireMode, base, height, slices, stacks );
+
     if (useWireMode)
     {
         GLushort  *sliceIdx, *stackIdx;
@@ -1931,14 +2229,10 @@ static void fghCone( GLfloat base, GLfloat height, GLint slices, GLint stacks, G
             sliceIdx[idx++] = offset+(stacks+1)*slices;
         }
 
-        /* draw */
-        fghDrawGeometryWire(vertices,normals,nVert,
+        /* the cache owns the arrays from here on */
+        fghShapeCacheStoreWire(shape,vertices,normals,nVert,
             sliceIdx,1,slices*2,GL_LINES,
             stackIdx,stacks,slices);
-
-        /* cleanup allocated memory */
-        free(sliceIdx);
-        free(stackIdx);
     }
     else
     {
@@ -1982,22 +2276,25 @@ static void fghCone( GLfloat base, GLfloat height, GLint slices, GLint stacks, G
             stripIdx[idx+1] = offset+slices;
         }
 
-        /* draw */
-        fghDrawGeometrySolid(vertices,normals,NULL,nVert,stripIdx,stacks+1,(slices+1)*2);
-
-        /* cleanup allocated memory */
-        free(stripIdx);
+        /* the cache owns the arrays from here on */
+        fghShapeCacheStoreSolid(shape,vertices,normals,nVert,stripIdx,stacks+1,(slices+1)*2);
     }
 
-    /* cleanup allocated memory */
-    free(vertices);
-    free(normals);
+    fghShapeCacheDraw( shape );
 }
 
 static void fghCylinder( GLfloat radius, GLfloat height, GLint slices, GLint stacks, GLboolean useWireMode )
 {
     int i,j,idx, nVert;
     GLfloat *vertices, *normals;
+    SFG_ShapeCacheEntry *shape;
+
+    shape = fghShapeCacheFind( FGH_SHAPE_CYLINDER, useWireMode, radius, height, slices, stacks );
+    if( shape )
+    {
+        fghShapeCacheDraw( shape );
+        return;
+    }
 
     /* Generate vertices and normals */
     /* Note, (stacks+1)*slices vertices for side of object, 2*slices+2 for top and bottom closures */
@@ -2007,6 +2304,8 @@ static void fghCylinder( GLfloat radius, GLfloat height, GLint slices, GLint sta
         /* nothing to draw */
         return;
 
+    shape = fghShapeCacheAdd( FGH_SHAPE_CYLINDER, useWireMode, radius, height, slices, stacks );
+
     if (useWireMode)
     {
         GLushort  *sliceIdx, *stackIdx;
@@ -2042,14 +2341,10 @@ static void fghCylinder( GLfloat radius, GLfloat height, GLint slices, GLint sta
             sliceIdx[idx++] = offset+(stacks+1)*slices;
         }
 
-        /* draw */
-        fghDrawGeometryWire(vertices,normals,nVert,
+        /* the cache owns the arrays from here on */
+        fghShapeCacheStoreWire(shape,vertices,normals,nVert,
             sliceIdx,1,slices*2,GL_LINES,
             stackIdx,stacks+1,slices);
-
-        /* cleanup allocated memory */
-        free(sliceIdx);
-        free(stackIdx);
     }
     else
     {
@@ -2103,22 +2398,25 @@ static void fghCylinder( GLfloat radius, GLfloat height, GLint slices, GLint sta
         stripIdx[idx  ] = offset;
         stripIdx[idx+1] = nVert-1;                  /* repeat first slice's idx for closing off shape */
 
-        /* draw */
-        fghDrawGeometrySolid(vertices,normals,NULL,nVert,stripIdx,stacks+2,(slices+1)*2);
-
-        /* cleanup allocated memory */
-        free(stripIdx);
+        /* the cache owns the arrays from here on */
+        fghShapeCacheStoreSolid(shape,vertices,normals,nVert,stripIdx,stacks+2,(slices+1)*2);
     }
 
-    /* cleanup allocated memory */
-    free(vertices);
-    free(normals);
+    fghShapeCacheDraw( shape );
 }
 
 static void fghTorus( GLfloat dInnerRadius, GLfloat dOuterRadius, GLint nSides, GLint nRings, GLboolean useWireMode )
 {
     int i,j,idx, nVert;
     GLfloat *vertices, *normals;
+    SFG_ShapeCacheEntry *shape;
+
+    shape = fghShapeCacheFind( FGH_SHAPE_TORUS, useWireMode, dInnerRadius, dOuterRadius, nSides, nRings );
+    if( shape )
+    {
+        fghShapeCacheDraw( shape );
+        return;
+    }
 
     /* Generate vertices and normals */
     fghGenerateTorus(dInnerRadius,dOuterRadius,nSides,nRings, &vertices,&normals,&nVert);
@@ -2127,6 +2425,8 @@ static void fghTorus( GLfloat dInnerRadius, GLfloat dOuterRadius, GLint nSides,
         /* nothing to draw */
         return;
 
+    shape = fghShapeCacheAdd( FGH_SHAPE_TORUS, useWireMode, dInnerRadius, dOuterRadius, nSides, nRings );
+
     if (useWireMode)
     {
         GLushort  *sideIdx, *ringIdx;
@@ -2154,14 +2454,10 @@ static void fghTorus( GLfloat dInnerRadius, GLfloat dOuterRadius, GLint nSides,
             for( j=0; j<nRings; j++, idx++ )
                 sideIdx[idx] = j * nSides + i;
 
-        /* draw */
-        fghDrawGeometryWire(vertices,normals,nVert,
+        /* the cache owns the arrays from here on */
+        fghShapeCacheStoreWire(shape,vertices,normals,nVert,
             ringIdx,nRings,nSides,GL_LINE_LOOP,
             sideIdx,nSides,nRings);
-
-        /* cleanup allocated memory */
-        free(sideIdx);
-        free(ringIdx);
     }
     else
     {
@@ -2197,16 +2493,11 @@ static void fghTorus( GLfloat dInnerRadius, GLfloat dOuterRadius, GLint nSides,
             idx +=2;
         }
 
-        /* draw */
-        fghDrawGeometrySolid(vertices,normals,NULL,nVert,stripIdx,nSides,(nRings+1)*2);
-
-        /* cleanup allocated memory */
-        free(stripIdx);
+        /* the cache owns the arrays from here on */
+        fghShapeCacheStoreSolid(shape,vertices,normals,nVert,stripIdx,nSides,(nRings+1)*2);
     }
 
-    /* cleanup allocated memory */
-    free(vertices);
-    free(normals);
+    fghShapeCacheDraw( shape );
 }
 
 
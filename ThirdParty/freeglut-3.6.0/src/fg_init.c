@@ -67,7 +67,8 @@ SFG_State fgState = { { -1, -1, GL_FALSE },  /* Position */
                       0,                     /* SwapCount */
                       0,                     /* SwapTime */
                       0,                     /* Time */
-                      { NULL, NULL },         /* Timers */
+                      0,                     /* EventTime */
+                      { NULL, 0, 0, 0 },      /* Timers */
                       { NULL, NULL },         /* FreeTimers */
                       NULL,                   /* IdleCallback */
                       NULL,                   /* IdleCallbackData */
@@ -99,7 +100,8 @@ SFG_State fgState = { { -1, -1, GL_FALSE },  /* Position */
                       NULL,                   /* ErrorFunc */
                       NULL,                   /* ErrorFuncData */
                       NULL,                   /* WarningFunc */
-                      NULL                    /* WarningFuncData */
+                      NULL,                   /* WarningFuncData */
+                      GL_FALSE                /* Headless */
 };
 
 
@@ -249,12 +251,12 @@ void fgDeinitialize( void )
     }
 
     fgDestroyStructure( );
+    /* Shapes of the windows went with them, these were drawn without one */
+    fgShapeCacheRelease( NULL );
 
-    while( ( timer = fgState.Timers.First) )
-    {
-        fgListRemove( &fgState.Timers, &timer->Node );
+    while( ( timer = fgTimerHeapRemoveFirst( &fgState.Timers ) ) )
         free( timer );
-    }
+    fgTimerHeapFree( &fgState.Timers );
 
     while( ( timer = fgState.FreeTimers.First) )
     {
@@ -262,7 +264,8 @@ void fgDeinitialize( void )
         free( timer );
     }
 
-    fgPlatformDeinitialiseInputDevices ();
+    if( !fgState.Headless )
+        fgPlatformDeinitialiseInputDevices ();
 
     fgState.MouseWheelTicks = 0;
 
@@ -299,7 +302,7 @@ void fgDeinitialize( void )
     fgState.GameModeDepth   = -1;
     fgState.GameModeRefresh = -1;
 
-    fgListInit( &fgState.Timers );
+    fgTimerHeapInit( &fgState.Timers );
     fgListInit( &fgState.FreeTimers );
 
     fgState.IdleCallback           = ( FGCBIdleUC )NULL;
@@ -318,8 +321,10 @@ void fgDeinitialize( void )
         fgState.ProgramName = NULL;
     }
 
-    fgPlatformCloseDisplay ();
+    if( !fgState.Headless )
+        fgPlatformCloseDisplay ();
 
+    fgState.Headless = GL_FALSE;
     fgState.Initialised = GL_FALSE;
 }
 
@@ -388,6 +393,39 @@ void FGAPIENTRY glutInit( int* pargc, char** argv )
     }
 }
 
+/*
+ * Initializes freeglut without connecting to the window system, for programs
+ * that render into a context of their own, such as an EGL pbuffer or
+ * surfaceless context. Fonts, timing and geometry work as usual; there is no
+ * display to open windows on or to take events from.
+ */
+void FGAPIENTRY glutInitHeadless( int* pargc, char** argv )
+{
+    char* displayName = NULL;
+    char* geometry = NULL;
+    if( fgState.Initialised )
+        fgError( "illegal glutInitHeadless() reinitialization attempt" );
+
+    if (pargc && *pargc && argv && *argv && **argv)
+    {
+        fgState.ProgramName = strdup (*argv);
+
+        if( !fgState.ProgramName )
+            fgError ("Could not allocate space for the program's name.");
+    }
+
+    fgCreateStructure( );
+
+    /* The standard options are still removed from argv, but have no effect */
+    fghParseCommandLineArguments ( pargc, argv, &displayName, &geometry );
+
+    fgState.Headless = GL_TRUE;
+    fgState.Time = fgSystemTimeNs();
+    fgState.Initialised = GL_TRUE;
+
+    atexit(fgDeinitialize);
+}
+
 /*
  * Undoes all the "glutInit" stuff
  */
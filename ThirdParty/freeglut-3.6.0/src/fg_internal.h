@@ -113,6 +113,7 @@
 /* -- FIXED CONFIGURATION LIMITS ------------------------------------------- */
 
 #define  FREEGLUT_MAX_MENUS            3
+#define  FREEGLUT_WINDOW_BUCKETS       256  /* Window lookup hash size, a power of two */
 
 /* These files should be available on every platform. */
 #include <stdio.h>
@@ -333,6 +334,16 @@ struct tagSFG_Node
     void *Prev;
 };
 
+/* A binary min-heap of pending timers, ordered by trigger time */
+typedef struct tagSFG_TimerHeap SFG_TimerHeap;
+struct tagSFG_TimerHeap
+{
+    struct tagSFG_Timer **Timers;       /* Heap array, earliest at index 0  */
+    int                 Count;          /* Number of pending timers         */
+    int                 Size;           /* Allocated size of the array      */
+    unsigned int        NextSequence;   /* Order stamp for the next insert  */
+};
+
 /* A helper structure holding two ints and a boolean */
 typedef struct tagSFG_XYUse SFG_XYUse;
 struct tagSFG_XYUse
@@ -377,8 +388,9 @@ struct tagSFG_State
     GLuint           SwapCount;            /* Count of glutSwapBuffer calls  */
     GLuint           SwapTime;             /* Time of last SwapBuffers       */
 
-    fg_time_t        Time;                 /* Time that glutInit was called  */
-    SFG_List         Timers;               /* The freeglut timer hooks       */
+    fg_time_t        Time;                 /* glutInit time, in nanoseconds  */
+    fg_time_t        EventTime;            /* Elapsed ns of the last event   */
+    SFG_TimerHeap    Timers;               /* The freeglut timer hooks       */
     SFG_List         FreeTimers;           /* The unused timer hooks         */
 
     FGCBIdleUC       IdleCallback;         /* The global idle callback       */
@@ -421,6 +433,8 @@ struct tagSFG_State
     FGCBUserData     ErrorFuncData;        /* User defined error handler user data */
     FGWarningUC      WarningFunc;          /* User defined warning handler  */
     FGCBUserData     WarningFuncData;      /* User defined warning handler user data */
+
+    GLboolean        Headless;             /* Initialized by glutInitHeadless, no display */
 };
 
 /* The structure used by display initialization in fg_init.c */
@@ -444,7 +458,8 @@ struct tagSFG_Timer
     int             ID;                 /* The timer ID integer              */
     FGCBTimerUC     Callback;           /* The timer callback                */
     FGCBUserData    CallbackData;       /* The timer callback user data      */
-    fg_time_t       TriggerTime;        /* The timer trigger time            */
+    fg_time_t       TriggerTime;        /* Elapsed time to fire at, in ns    */
+    unsigned int    Sequence;           /* Insertion order, breaks ties      */
 };
 
 /*
@@ -811,6 +826,12 @@ struct tagSFG_Window
     SFG_List            Children;               /* The subwindows d.l. list  */
 
     GLboolean           IsMenu;                 /* Set to 1 if we are a menu */
+
+    /* Hash chains for fgWindowByHandle and fgWindowByID, see fg_structure.c */
+    SFG_Window*         NextByHandle;           /* Next in the handle bucket */
+    SFG_Window*         NextByID;               /* Next in the ID bucket     */
+    SFG_WindowHandleType HashedHandle;          /* Handle it is filed under  */
+    GLboolean           HandleHashed;           /* Filed by handle at all?   */
 };
 
 
@@ -839,6 +860,9 @@ struct tagSFG_Structure
 
     int              WindowID;       /* The window ID for the next window to be created */
     int              MenuID;         /* The menu ID for the next menu to be created */
+
+    SFG_Window*      WindowsByHandle[ FREEGLUT_WINDOW_BUCKETS ]; /* Windows hashed by native handle */
+    SFG_Window*      WindowsByID[ FREEGLUT_WINDOW_BUCKETS ];     /* Windows hashed by ID */
 };
 
 /*
@@ -1075,6 +1099,9 @@ void        fgAddToWindowDestroyList ( SFG_Window* window );
 void        fgCloseWindows ();
 void        fgDestroyWindow( SFG_Window* window );
 
+/* Cached geometry of the round shapes, defined in fg_geometry.c */
+void        fgShapeCacheRelease( SFG_Window *window );
+
 /* Menu creation and destruction. Defined in fg_structure.c */
 SFG_Menu*   fgCreateMenu( FGCBMenuUC menuCallback, FGCBUserData userData );
 void        fgDestroyMenu( SFG_Menu* menu );
@@ -1132,6 +1159,14 @@ SFG_Window* fgWindowByHandle( SFG_WindowHandleType hWindow );
  */
 SFG_Window* fgWindowByID( int windowID );
 
+/*
+ * Files a window in, and removes it from, the lookup tables used by the two
+ * functions above. fgHashWindowHandle is called again whenever the window's
+ * native handle changes. The functions are defined in fg_structure.c file.
+ */
+void fgHashWindowHandle( SFG_Window* window );
+void fgUnhashWindow( SFG_Window* window );
+
 /*
  * Looks up a menu given its ID. This is easier than fgWindowByXXX
  * as all menus are placed in a single doubly linked list...
@@ -1160,11 +1195,21 @@ void fgDeactivateMenu( SFG_Window *window );
  */
 void fgDisplayMenu( void );
 
+/*
+ * Timeout passed to fgPlatformSleepForEvents when no timer or joystick poll
+ * is pending, in nanoseconds. Platforms that wait in milliseconds get INT_MAX
+ * after rounding down, as they did before the wait took nanoseconds.
+ */
+#define FG_NO_WAKEUP ( ( fg_time_t )0x7fffffff * 1000000 )
+
 /* Elapsed time as per glutGet(GLUT_ELAPSED_TIME). */
 fg_time_t fgElapsedTime( void );
+/* Elapsed time as per glutGetElapsedTimeNs(). */
+fg_time_t fgElapsedTimeNs( void );
 
-/* System time in milliseconds */
+/* System time in milliseconds and nanoseconds */
 fg_time_t fgSystemTime(void);
+fg_time_t fgSystemTimeNs(void);
 
 /* List functions */
 void fgListInit(SFG_List *list);
@@ -1173,6 +1218,13 @@ void fgListRemove(SFG_List *list, SFG_Node *node);
 int fgListLength(SFG_List *list);
 void fgListInsert(SFG_List *list, SFG_Node *next, SFG_Node *node);
 
+/* Timer heap functions */
+void fgTimerHeapInit(SFG_TimerHeap *heap);
+void fgTimerHeapInsert(SFG_TimerHeap *heap, SFG_Timer *timer);
+SFG_Timer *fgTimerHeapFirst(SFG_TimerHeap *heap);
+SFG_Timer *fgTimerHeapRemoveFirst(SFG_TimerHeap *heap);
+void fgTimerHeapFree(SFG_TimerHeap *heap);
+
 /* Error Message functions */
 void fgError( const char *fmt, ... );
 void fgWarning( const char *fmt, ... );
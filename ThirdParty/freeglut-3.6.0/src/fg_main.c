@@ -46,8 +46,8 @@
 #endif
 
 extern void fgProcessWork   ( SFG_Window *window );
-extern fg_time_t fgPlatformSystemTime ( void );
-extern void fgPlatformSleepForEvents( fg_time_t msec );
+extern fg_time_t fgPlatformSystemTimeNs ( void );
+extern void fgPlatformSleepForEvents( fg_time_t nsec );
 extern void fgPlatformProcessSingleEvent ( void );
 extern void fgPlatformMainLoopPreliminaryWork ( void );
 
@@ -198,6 +198,28 @@ static void fghcbCheckJoystickPolls( SFG_Window *window,
     fgEnumSubWindows( window, fghcbCheckJoystickPolls, enumerator );
 }
 
+/*
+ * Window enumerator callback to find the next joystick poll, in nanoseconds
+ * from now
+ */
+static void fghcbNextJoystickPoll( SFG_Window *window,
+                                   SFG_Enumerator *enumerator )
+{
+    if (window->State.JoystickPollRate > 0 && FETCH_WCB( *window, Joystick ))
+    {
+        fg_time_t *nextPoll = ( fg_time_t * )enumerator->data;
+        fg_time_t pollTime = ( window->State.JoystickLastPoll +
+                               window->State.JoystickPollRate ) * 1000000;
+        fg_time_t currentTime = fgElapsedTimeNs( );
+        fg_time_t wait = pollTime > currentTime ? pollTime - currentTime : 0;
+
+        if( wait < *nextPoll )
+            *nextPoll = wait;
+    }
+
+    fgEnumSubWindows( window, fghcbNextJoystickPoll, enumerator );
+}
+
 /*
  * Check all windows for joystick polling
  *
@@ -220,17 +242,16 @@ static void fghCheckJoystickPolls( void )
  */
 static void fghCheckTimers( void )
 {
-    fg_time_t checkTime = fgElapsedTime( );
+    fg_time_t checkTime = fgElapsedTimeNs( );
+    SFG_Timer *timer;
 
-    while( fgState.Timers.First )
+    while( ( timer = fgTimerHeapFirst( &fgState.Timers ) ) )
     {
-        SFG_Timer *timer = fgState.Timers.First;
-
         if( timer->TriggerTime > checkTime )
-            /* Timers are sorted by triggerTime */
+            /* The heap root is the earliest timer */
             break;
 
-        fgListRemove( &fgState.Timers, &timer->Node );
+        fgTimerHeapRemoveFirst( &fgState.Timers );
         fgListAppend( &fgState.FreeTimers, &timer->Node );
 
         timer->Callback( timer->ID, timer->CallbackData );
@@ -238,23 +259,33 @@ static void fghCheckTimers( void )
 }
 
 
-/* Platform-dependent time in milliseconds, as an unsigned 64-bit integer.
- * This doesn't overflow in any reasonable time, so no need to worry about
- * that. The GLUT API return value will however overflow after 49.7 days,
- * which means you will still get in trouble when running the
- * application for more than 49.7 days.
+/* Platform-dependent monotonic time in nanoseconds, as an unsigned 64-bit
+ * integer. This doesn't overflow in any reasonable time (584 years), so no
+ * need to worry about that. The millisecond GLUT API return value will
+ * however overflow after 49.7 days, which means you will still get in
+ * trouble when running the application for more than 49.7 days.
  */
+fg_time_t fgSystemTimeNs(void)
+{
+    return fgPlatformSystemTimeNs();
+}
+
 fg_time_t fgSystemTime(void)
 {
-    return fgPlatformSystemTime();
+    return fgSystemTimeNs() / 1000000;
 }
 
 /*
  * Elapsed Time
  */
+fg_time_t fgElapsedTimeNs( void )
+{
+    return fgSystemTimeNs() - fgState.Time;
+}
+
 fg_time_t fgElapsedTime( void )
 {
-    return fgSystemTime() - fgState.Time;
+    return fgElapsedTimeNs() / 1000000;
 }
 
 /*
@@ -349,37 +380,58 @@ static int fghHavePendingWork (void)
 }
 
 /*
- * Returns the number of GLUT ticks (milliseconds) till the next timer event.
+ * Returns the number of nanoseconds till the next timer event, or
+ * FG_NO_WAKEUP if there is none.
  */
 static fg_time_t fghNextTimer( void )
 {
     fg_time_t currentTime;
-    SFG_Timer *timer = fgState.Timers.First;    /* timers are sorted by trigger time, so only have to check the first */
+    SFG_Timer *timer = fgTimerHeapFirst( &fgState.Timers );    /* the heap root is the earliest timer, so only have to check that */
 
     if( !timer )
-        return INT_MAX;
+        return FG_NO_WAKEUP;
 
-    currentTime = fgElapsedTime();
+    currentTime = fgElapsedTimeNs();
     if( timer->TriggerTime < currentTime )
         return 0;
     else
         return timer->TriggerTime - currentTime;
 }
 
-static void fghSleepForEvents( void )
+/*
+ * Returns the number of nanoseconds till a window's joystick is next due
+ * for polling, or FG_NO_WAKEUP if none is polled automatically.
+ */
+static fg_time_t fghNextJoystickPoll( void )
+{
+    SFG_Enumerator enumerator;
+    fg_time_t nextPoll = FG_NO_WAKEUP;
+
+    enumerator.found = GL_FALSE;
+    enumerator.data  = &nextPoll;
+
+    fgEnumWindows( fghcbNextJoystickPoll, &enumerator );
+    return nextPoll;
+}
+
+static void fghSleepForEvents( fg_time_t limit )
 {
-    fg_time_t msec;
+    fg_time_t nsec;
 
-    if( fghHavePendingWork( ) )
+    /* Without a display there are no events to wait for */
+    if( fghHavePendingWork( ) || fgState.Headless )
         return;
 
-    msec = fghNextTimer( );
-    /* XXX Should use GLUT timers for joysticks... */
-    /* XXX Dumb; forces granularity to .01sec */
-    if( fgState.NumActiveJoysticks>0 && ( msec > 10 ) )
-        msec = 10;
+    nsec = fghNextTimer( );
+    nsec = MIN( nsec, limit );
+    /* Wake up exactly when the next joystick poll is due */
+    if( fgState.NumActiveJoysticks>0 )
+    {
+        fg_time_t nextPoll = fghNextJoystickPoll( );
+        nsec = MIN( nsec, nextPoll );
+    }
 
-    fgPlatformSleepForEvents ( msec );
+    fgPlatformSleepForEvents ( nsec );
 }
 
 
@@ -445,10 +497,13 @@ void fgProcessWork(SFG_Window *window)
  */
 void FGAPIENTRY glutMainLoopEvent( void )
 {
-    /* Process input */
-    fgPlatformProcessSingleEvent ();
+    /* Process input. Platforms that know when each event happened
+     * overwrite the event time while dispatching it. */
+    fgState.EventTime = fgElapsedTimeNs( );
+    if( !fgState.Headless )
+        fgPlatformProcessSingleEvent ();
 
-    if( fgState.Timers.First )
+    if( fgState.Timers.Count )
         fghCheckTimers( );
     if (fgState.NumActiveJoysticks>0)   /* If zero, don't poll joysticks */
         fghCheckJoystickPolls( );
@@ -466,6 +521,18 @@ void FGAPIENTRY glutMainLoopEvent( void )
     fgCloseWindows( );
 }
 
+/*
+ * Blocks until there is something for glutMainLoopEvent() to do, or for
+ * at most the given number of nanoseconds. For programs that run their
+ * own loop instead of glutMainLoop().
+ */
+void FGAPIENTRY glutWaitForEventsNs( unsigned long long timeout )
+{
+    FREEGLUT_EXIT_IF_NOT_INITIALISED ( "glutWaitForEventsNs" );
+
+    fghSleepForEvents( timeout < FG_NO_WAKEUP ? ( fg_time_t )timeout : FG_NO_WAKEUP );
+}
+
 /*
  * Enters the freeglut processing loop.
  * Stays until the "ExecState" changes to "GLUT_EXEC_STATE_STOP".
@@ -512,7 +579,7 @@ void FGAPIENTRY glutMainLoop( void )
                 fgState.IdleCallback( fgState.IdleCallbackData );
             }
             else
-                fghSleepForEvents( );
+                fghSleepForEvents( FG_NO_WAKEUP );
         }
     }
 
@@ -146,7 +146,7 @@ int FGAPIENTRY glutGet( GLenum eWhat )
      * here still wraps every 49.7 days. Integer overflows cancel however
      * when subtracting an initial start time, unless the total time exceeds
      * 32-bit, so you can still work with this.
-     * XXX: a glutGet64 to return the time might be an idea...
+     * glutGetElapsedTimeNs returns the full 64-bit time.
      */
     case GLUT_ELAPSED_TIME:
         return (int) fgElapsedTime();
@@ -238,6 +238,26 @@ int FGAPIENTRY glutGet( GLenum eWhat )
     }
 }
 
+/*
+ * Returns the time since glutInit in nanoseconds, unlike
+ * glutGet(GLUT_ELAPSED_TIME) neither truncated to milliseconds nor wrapping.
+ */
+unsigned long long FGAPIENTRY glutGetElapsedTimeNs( void )
+{
+    return fgElapsedTimeNs();
+}
+
+/*
+ * Returns when the input event being dispatched, or the last one, happened,
+ * on the same clock as glutGetElapsedTimeNs. Where the windowing system
+ * timestamps its events this is earlier than the time the callback runs.
+ */
+unsigned long long FGAPIENTRY glutGetEventTimeNs( void )
+{
+    FREEGLUT_EXIT_IF_NOT_INITIALISED ( "glutGetEventTimeNs" );
+    return fgState.EventTime;
+}
+
 /*
  * Returns various device information.
  */
@@ -43,7 +43,9 @@ SFG_Structure fgStructure = { { NULL, NULL },  /* The list of windows       */
                               NULL,            /* The menu OpenGL context   */
                               NULL,            /* The game mode window      */
                               0,               /* The current new window ID */
-                              0 };             /* The current new menu ID   */
+                              0,               /* The current new menu ID   */
+                              { NULL },        /* Windows by native handle  */
+                              { NULL } };      /* Windows by ID             */
 
 
 /* -- PRIVATE FUNCTIONS ---------------------------------------------------- */
@@ -78,6 +80,9 @@ SFG_Window* fgCreateWindow( SFG_Window* parent, const char* title,
     /* Have the window object created */
     SFG_Window *window = (SFG_Window *)calloc( 1, sizeof(SFG_Window) );
 
+    if( fgState.Headless )
+        fgError( "Cannot create a window, freeglut was initialized headless" );
+
     if( !window )
     {
         fgError( "Out of memory. Could not create window." );
@@ -90,6 +95,8 @@ SFG_Window* fgCreateWindow( SFG_Window* parent, const char* title,
 
     /* Initialize the object properties */
     window->ID = ++fgStructure.WindowID;
+    window->NextByID = fgStructure.WindowsByID[ window->ID & ( FREEGLUT_WINDOW_BUCKETS - 1 ) ];
+    fgStructure.WindowsByID[ window->ID & ( FREEGLUT_WINDOW_BUCKETS - 1 ) ] = window;
 
     fgListInit( &window->Children );
     if( parent )
@@ -219,6 +226,8 @@ void fgDestroyWindow( SFG_Window* window )
     {
         SFG_Window *activeWindow = fgStructure.CurrentWindow;
         INVOKE_WCB( *window, Destroy, ( ) );
+        /* Switches to the window's context if it has shape buffers to delete */
+        fgShapeCacheRelease( window );
         fgSetWindow( activeWindow );
     }
 
@@ -226,6 +235,7 @@ void fgDestroyWindow( SFG_Window* window )
         fgListRemove( &window->Parent->Children, &window->Node );
     else
         fgListRemove( &fgStructure.Windows, &window->Node );
+    fgUnhashWindow( window );
 
     if( window->ActiveMenu )
       fgDeactivateMenu( window );
@@ -455,6 +465,83 @@ void fgEnumSubWindows( SFG_Window* window, FGCBWindowEnumerator enumCallback,
     }
 }
 
+/*
+ * Hashes a native window handle. The handle type differs per platform
+ * (an integer XID, a HWND, an EGL native pointer...), so hash its bytes.
+ */
+static unsigned int fghHashHandle( SFG_WindowHandleType hWindow )
+{
+    const unsigned char *bytes = ( const unsigned char * )&hWindow;
+    unsigned int hash = 2166136261u;    /* FNV-1a */
+    size_t i;
+
+    for( i = 0; i < sizeof( hWindow ); i++ )
+        hash = ( hash ^ bytes[ i ] ) * 16777619u;
+
+    return hash & ( FREEGLUT_WINDOW_BUCKETS - 1 );
+}
+
+/*
+ * Removes a window from the handle hash chain it is filed in, if any.
+ */
+static void fghUnhashWindowHandle( SFG_Window *window )
+{
+    SFG_Window **link;
+
+    if( !window->HandleHashed )
+        return;
+
+    for( link = &fgStructure.WindowsByHandle[ fghHashHandle( window->HashedHandle ) ];
+         *link;
+         link = &( *link )->NextByHandle )
+    {
+        if( *link == window )
+        {
+            *link = window->NextByHandle;
+            break;
+        }
+    }
+
+    window->HandleHashed = GL_FALSE;
+}
+
+/*
+ * Files a window under its current native handle, so that fgWindowByHandle
+ * finds it without walking the window tree.
+ */
+void fgHashWindowHandle( SFG_Window *window )
+{
+    unsigned int bucket = fghHashHandle( window->Window.Handle );
+
+    fghUnhashWindowHandle( window );
+
+    window->HashedHandle = window->Window.Handle;
+    window->HandleHashed = GL_TRUE;
+    window->NextByHandle = fgStructure.WindowsByHandle[ bucket ];
+    fgStructure.WindowsByHandle[ bucket ] = window;
+}
+
+/*
+ * Removes a window from both lookup tables, before it is destroyed.
+ */
+void fgUnhashWindow( SFG_Window *window )
+{
+    SFG_Window **link;
+
+    fghUnhashWindowHandle( window );
+
+    for( link = &fgStructure.WindowsByID[ window->ID & ( FREEGLUT_WINDOW_BUCKETS - 1 ) ];
+         *link;
+         link = &( *link )->NextByID )
+    {
+        if( *link == window )
+        {
+            *link = window->NextByID;
+            break;
+        }
+    }
+}
+
 /*
  * A static helper function to look for a window given its handle
  */
@@ -485,37 +572,33 @@ static void fghcbWindowByHandle( SFG_Window *window,
 SFG_Window* fgWindowByHandle ( SFG_WindowHandleType hWindow )
 {
     SFG_Enumerator enumerator;
+    SFG_Window *window;
 
-    /* This is easy and makes use of the windows enumeration defined above */
+    /* Windows are filed by handle once they are open, see fgOpenWindow */
+    for( window = fgStructure.WindowsByHandle[ fghHashHandle( hWindow ) ];
+         window;
+         window = window->NextByHandle )
+    {
+        if( window->HashedHandle == hWindow && window->Window.Handle == hWindow )
+            return window;
+    }
+
+    /*
+     * Some platforms deliver events for a window before fgOpenWindow has
+     * returned, or change its handle later on. Fall back to walking the
+     * windows, and file what is found so the next lookup is quick.
+     */
     enumerator.found = GL_FALSE;
     enumerator.data = (void *)hWindow;
     fgEnumWindows( fghcbWindowByHandle, &enumerator );
 
     if( enumerator.found )
-        return( SFG_Window *) enumerator.data;
-    return NULL;
-}
-
-/*
- * A static helper function to look for a window given its ID
- */
-static void fghcbWindowByID( SFG_Window *window, SFG_Enumerator *enumerator )
-{
-    /* Make sure we do not overwrite our precious results... */
-    if( enumerator->found )
-        return;
-
-    /* Check the window's handle. Hope this works. Looks ugly. That's for sure. */
-    if( window->ID == *( int *)(enumerator->data) )
     {
-        enumerator->found = GL_TRUE;
-        enumerator->data = window;
-
-        return;
+        window = ( SFG_Window * )enumerator.data;
+        fgHashWindowHandle( window );
+        return window;
     }
-
-    /* Otherwise, check this window's children */
-    fgEnumSubWindows( window, fghcbWindowByID, enumerator );
+    return NULL;
 }
 
 /*
@@ -525,14 +608,16 @@ static void fghcbWindowByID( SFG_Window *window, SFG_Enumerator *enumerator )
  */
 SFG_Window* fgWindowByID( int windowID )
 {
-    SFG_Enumerator enumerator;
+    SFG_Window *window;
 
-    /* Uses a method very similar for fgWindowByHandle... */
-    enumerator.found = GL_FALSE;
-    enumerator.data = ( void * )&windowID;
-    fgEnumWindows( fghcbWindowByID, &enumerator );
-    if( enumerator.found )
-        return ( SFG_Window * )enumerator.data;
+    /* Every window is filed by ID from fgCreateWindow until it is destroyed */
+    for( window = fgStructure.WindowsByID[ windowID & ( FREEGLUT_WINDOW_BUCKETS - 1 ) ];
+         window;
+         window = window->NextByID )
+    {
+        if( window->ID == windowID )
+            return window;
+    }
     return NULL;
 }
 
@@ -686,4 +771,107 @@ void fgListInsert(SFG_List *list, SFG_Node *next, SFG_Node *node)
         list->First = node;
 }
 
+/*
+ * Timer heap functions...
+ *
+ * Pending timers are kept in a binary min-heap so that adding a timer and
+ * taking the earliest one are both O(log n). Timers with the same trigger
+ * time fire in the order they were set, as they did with the sorted list.
+ */
+static int fghTimerBefore( const SFG_Timer *a, const SFG_Timer *b )
+{
+    if( a->TriggerTime != b->TriggerTime )
+        return a->TriggerTime < b->TriggerTime;
+
+    /* The sequence counter may wrap, so compare the difference */
+    return (int)( a->Sequence - b->Sequence ) < 0;
+}
+
+void fgTimerHeapInit(SFG_TimerHeap *heap)
+{
+    heap->Timers = NULL;
+    heap->Count = 0;
+    heap->Size = 0;
+    heap->NextSequence = 0;
+}
+
+void fgTimerHeapInsert(SFG_TimerHeap *heap, SFG_Timer *timer)
+{
+    int index;
+
+    if( heap->Count == heap->Size )
+    {
+        int size = heap->Size ? heap->Size * 2 : 16;
+        SFG_Timer **timers = realloc( heap->Timers, size * sizeof( SFG_Timer * ) );
+
+        if( !timers )
+            fgError( "Fatal error: "
+                     "Memory allocation failure in glutTimerFunc()" );
+
+        heap->Timers = timers;
+        heap->Size = size;
+    }
+
+    timer->Sequence = heap->NextSequence++;
+
+    /* Sift up from the new leaf */
+    index = heap->Count++;
+    while( index > 0 )
+    {
+        int parent = ( index - 1 ) / 2;
+
+        if( !fghTimerBefore( timer, heap->Timers[ parent ] ) )
+            break;
+
+        heap->Timers[ index ] = heap->Timers[ parent ];
+        index = parent;
+    }
+    heap->Timers[ index ] = timer;
+}
+
+SFG_Timer *fgTimerHeapFirst(SFG_TimerHeap *heap)
+{
+    return heap->Count ? heap->Timers[ 0 ] : NULL;
+}
+
+SFG_Timer *fgTimerHeapRemoveFirst(SFG_TimerHeap *heap)
+{
+    SFG_Timer *first, *last;
+    int index = 0;
+
+    if( !heap->Count )
+        return NULL;
+
+    first = heap->Timers[ 0 ];
+    last = heap->Timers[ --heap->Count ];
+
+    /* Sift the last leaf down from the root */
+    while( 1 )
+    {
+        int child = 2 * index + 1;
+
+        if( child >= heap->Count )
+            break;
+        if( child + 1 < heap->Count &&
+            fghTimerBefore( heap->Timers[ child + 1 ], heap->Timers[ child ] ) )
+            ++child;
+        if( !fghTimerBefore( heap->Timers[ child ], last ) )
+            break;
+
+        heap->Timers[ index ] = heap->Timers[ child ];
+        index = child;
+    }
+    if( heap->Count )
+        heap->Timers[ index ] = last;
+
+    return first;
+}
+
+/* Releases the heap array. The timers themselves are owned by the caller. */
+void fgTimerHeapFree(SFG_TimerHeap *heap)
+{
+    free( heap->Timers );
+    fgTimerHeapInit( heap );
+}
+
 /*** END OF FILE ***/
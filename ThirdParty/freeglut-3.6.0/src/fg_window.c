@@ -131,6 +131,7 @@ void fgOpenWindow( SFG_Window* window, const char* title,
                           sizeUse, w, h,
                           gameMode, isSubWindow );
 
+    fgHashWindowHandle( window );
     fgSetWindow( window );
 
 #ifndef EGL_VERSION_1_0
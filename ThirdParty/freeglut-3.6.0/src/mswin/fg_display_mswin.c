@@ -35,3 +35,16 @@ void fgPlatformGlutSwapBuffers( SFG_PlatformDisplay *pDisplayPtr, SFG_Window* Cu
 {
     SwapBuffers( CurrentWindow->Window.pContext.Device );
 }
+
+
+typedef BOOL (WINAPI *SwapIntervalEXTProc)( int interval );
+
+int fgPlatformSwapInterval( SFG_PlatformDisplay *pDisplayPtr, SFG_Window* CurrentWindow, int interval )
+{
+    /* WGL_EXT_swap_control works on the window of the current context */
+    SwapIntervalEXTProc swapIntervalEXT = (SwapIntervalEXTProc) wglGetProcAddress( "wglSwapIntervalEXT" );
+    if( !swapIntervalEXT )
+        return GL_FALSE;
+
+    return swapIntervalEXT( interval ) ? GL_TRUE : GL_FALSE;
+}
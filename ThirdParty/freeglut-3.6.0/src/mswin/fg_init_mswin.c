@@ -119,7 +119,7 @@ void fgPlatformInitialize( const char* displayName )
     /* Init setup to deal with timer wrap, can't query system time before this is done */
     fgPlatformInitSystemTime();
     /* Get start time */
-    fgState.Time = fgSystemTime();
+    fgState.Time = fgSystemTimeNs();
 
 
     fgState.Initialised = GL_TRUE;
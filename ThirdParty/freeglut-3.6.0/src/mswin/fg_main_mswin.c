@@ -446,44 +446,57 @@ char* WMMsg2Str(DWORD dwMessage)
 #endif /* _DEBUG */
 
 
-/* Get system time, taking special precautions against 32bit timer wrap.
-   We use timeGetTime and not GetTickCount because of its better stability,
-   and because we can increase its granularity (to 1 ms in
-   fgPlatformInitialize). For that reason we can't use GetTickCount64 which
-   wouldn't have the wrap issue.
-   Credit: this is based on code in glibc (https://mail.gnome.org/archives/commits-list/2011-November/msg04588.html)
+/* Get system time in nanoseconds.
+   On desktop Windows this is the performance counter, which is monotonic and
+   has sub-microsecond resolution. Windows CE falls back to GetTickCount,
+   taking special precautions against 32bit timer wrap.
+   Credit: the wrap handling is based on code in glibc (https://mail.gnome.org/archives/commits-list/2011-November/msg04588.html)
    */
+#if defined(_WIN32_WCE)
 static fg_time_t lastTime32 = 0;
 static fg_time_t timeEpoch = 0;
+#else
+static fg_time_t counterFrequency = 1;
+#endif
 void fgPlatformInitSystemTime()
 {
 #if defined(_WIN32_WCE)
     lastTime32 = GetTickCount();
 #else
-    lastTime32 = timeGetTime();
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);
+    counterFrequency = frequency.QuadPart;
 #endif
 }
-fg_time_t fgPlatformSystemTime ( void )
+fg_time_t fgPlatformSystemTimeNs ( void )
 {
-    fg_time_t currTime32;
 #if defined(_WIN32_WCE)
-    currTime32 = GetTickCount();
-#else
-    currTime32 = timeGetTime();
-#endif
+    fg_time_t currTime32 = GetTickCount();
+
     /* Check if we just wrapped */
     if (currTime32 < lastTime32)
         timeEpoch++;
 
     lastTime32 = currTime32;
 
-    return currTime32 | timeEpoch << 32;
+    return (currTime32 | timeEpoch << 32) * 1000000;
+#else
+    LARGE_INTEGER counter;
+    fg_time_t ticks;
+
+    QueryPerformanceCounter(&counter);
+    ticks = counter.QuadPart;
+
+    /* Split the conversion so that ticks * 10^9 can't overflow */
+    return ticks / counterFrequency * 1000000000 +
+           ticks % counterFrequency * 1000000000 / counterFrequency;
+#endif
 }
 
 
-void fgPlatformSleepForEvents( fg_time_t msec )
+void fgPlatformSleepForEvents( fg_time_t nsec )
 {
-    MsgWaitForMultipleObjects( 0, NULL, FALSE, (DWORD) msec, QS_ALLINPUT );
+    MsgWaitForMultipleObjects( 0, NULL, FALSE, (DWORD) ( nsec / 1000000 ), QS_ALLINPUT );
 }
 
 
@@ -109,3 +109,10 @@ void fgPlatformGlutSwapBuffers(SFG_PlatformDisplay *pDisplayPtr,
 {
     fgOgcDisplayShowEFB();
 }
+
+int fgPlatformSwapInterval(SFG_PlatformDisplay *pDisplayPtr,
+                           SFG_Window *CurrentWindow, int interval)
+{
+    /* Double buffered swaps always wait for the next retrace */
+    return interval == 1;
+}
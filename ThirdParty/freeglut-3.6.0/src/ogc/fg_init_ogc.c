@@ -42,7 +42,7 @@ void fgPlatformInitialize(const char *displayName)
 
     fatInitDefault();
 
-    fgState.Time = fgSystemTime();
+    fgState.Time = fgSystemTimeNs();
     fgState.FPSInterval = 2000;
     fgState.Initialised = GL_TRUE;
 }
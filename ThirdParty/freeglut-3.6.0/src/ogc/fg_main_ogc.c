@@ -199,14 +199,14 @@ static void updateMouse()
 }
 #endif
 
-fg_time_t fgPlatformSystemTime(void)
+fg_time_t fgPlatformSystemTimeNs(void)
 {
-    return gettime() / TB_TIMER_CLOCK;
+    return ticks_to_nanosecs(gettime());
 }
 
-void fgPlatformSleepForEvents(fg_time_t ms)
+void fgPlatformSleepForEvents(fg_time_t ns)
 {
-    fgWarning("%s() : sleeping for %lld ms", __func__, ms);
+    fgWarning("%s() : sleeping for %lld ns", __func__, ns);
 
     /* FreeGlut does not offer a hook for redrawing the window in single-buffer
      * mode, so let's to it here. */
@@ -215,8 +215,8 @@ void fgPlatformSleepForEvents(fg_time_t ms)
     }
 
     struct timespec tv;
-    tv.tv_sec = ms / 1000;
-    tv.tv_nsec = (ms % 1000) * 1000000;
+    tv.tv_sec = ns / 1000000000;
+    tv.tv_nsec = ns % 1000000000;
     nanosleep(&tv, NULL);
 }
 
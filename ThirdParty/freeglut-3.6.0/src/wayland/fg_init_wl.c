@@ -100,7 +100,7 @@ void fgPlatformInitialize( const char* displayName )
     fghPlatformInitializeEGL();
 
     /* Get start time */
-    fgState.Time = fgSystemTime();
+    fgState.Time = fgSystemTimeNs();
 
     fgState.Initialised = GL_TRUE;
 
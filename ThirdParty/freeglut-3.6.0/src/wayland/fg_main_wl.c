@@ -29,6 +29,8 @@
 #include "../fg_internal.h"
 #include <errno.h>
 #include <poll.h>
+/* clock_gettime; fg_internal.h only pulls in <sys/time.h> on most systems */
+#include <time.h>
 
 void fgPlatformFullScreenToggle( SFG_Window *win );
 void fgPlatformPositionWindow( SFG_Window *window, int x, int y );
@@ -40,23 +42,24 @@ void fgPlatformIconifyWindow( SFG_Window *window );
 void fgPlatformShowWindow( SFG_Window *window );
 
 
-fg_time_t fgPlatformSystemTime( void )
+fg_time_t fgPlatformSystemTimeNs( void )
 {
 #ifdef CLOCK_MONOTONIC
     struct timespec now;
     clock_gettime(CLOCK_MONOTONIC, &now);
-    return now.tv_nsec/1000000 + now.tv_sec*1000;
+    return now.tv_nsec + (fg_time_t)now.tv_sec*1000000000;
 #elif defined(HAVE_GETTIMEOFDAY)
     struct timeval now;
     gettimeofday( &now, NULL );
-    return now.tv_usec/1000 + now.tv_sec*1000;
+    return now.tv_usec*1000 + (fg_time_t)now.tv_sec*1000000000;
 #endif
 }
 
-void fgPlatformSleepForEvents( fg_time_t msec )
+void fgPlatformSleepForEvents( fg_time_t nsec )
 {
     struct pollfd pfd;
     int err;
+    int msec = (int)( nsec / 1000000 );
 
     pfd.fd = wl_display_get_fd( fgDisplay.pDisplay.display );
     pfd.events = POLLIN | POLLERR | POLLHUP;
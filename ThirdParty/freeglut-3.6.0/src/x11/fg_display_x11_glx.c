@@ -34,3 +34,62 @@ void fgPlatformGlutSwapBuffers( SFG_PlatformDisplay *pDisplayPtr, SFG_Window* Cu
     glXSwapBuffers( pDisplayPtr->Display, CurrentWindow->Window.Handle );
 }
 
+
+typedef void (*SwapIntervalEXTProc)( Display *dpy, GLXDrawable drawable, int interval );
+typedef int (*SwapIntervalMESAProc)( unsigned int interval );
+typedef int (*SwapIntervalSGIProc)( int interval );
+
+/*
+ * Whole-word match in the GLX extension string, so that for example
+ * GLX_EXT_swap_control is not found in GLX_EXT_swap_control_tear
+ */
+static int fghIsGLXExtensionSupported( SFG_PlatformDisplay *pDisplayPtr, const char *extension )
+{
+    const char *extensions = glXQueryExtensionsString( pDisplayPtr->Display, pDisplayPtr->Screen );
+    const size_t length = strlen( extension );
+    const char *p = extensions;
+
+    while( p && ( p = strstr( p, extension ) ) != NULL )
+    {
+        if( ( p == extensions || p[ -1 ] == ' ' ) &&
+            ( p[ length ] == ' ' || p[ length ] == '\0' ) )
+            return GL_TRUE;
+        p += length;
+    }
+    return GL_FALSE;
+}
+
+int fgPlatformSwapInterval( SFG_PlatformDisplay *pDisplayPtr, SFG_Window* CurrentWindow, int interval )
+{
+    /*
+     * GLX_EXT_swap_control works on the drawable, the MESA and SGI variants on
+     * whatever is current, which is the current window's context here.
+     */
+    if( fghIsGLXExtensionSupported( pDisplayPtr, "GLX_EXT_swap_control" ) )
+    {
+        SwapIntervalEXTProc swapIntervalEXT = (SwapIntervalEXTProc) fgPlatformGetProcAddress( "glXSwapIntervalEXT" );
+        if( swapIntervalEXT )
+        {
+            swapIntervalEXT( pDisplayPtr->Display, CurrentWindow->Window.Handle, interval );
+            return GL_TRUE;
+        }
+    }
+
+    if( fghIsGLXExtensionSupported( pDisplayPtr, "GLX_MESA_swap_control" ) )
+    {
+        SwapIntervalMESAProc swapIntervalMESA = (SwapIntervalMESAProc) fgPlatformGetProcAddress( "glXSwapIntervalMESA" );
+        if( swapIntervalMESA )
+            return swapIntervalMESA( (unsigned int)interval ) == 0;
+    }
+
+    /* GLX_SGI_swap_control cannot turn vertical sync off */
+    if( interval > 0 && fghIsGLXExtensionSupported( pDisplayPtr, "GLX_SGI_swap_control" ) )
+    {
+        SwapIntervalSGIProc swapIntervalSGI = (SwapIntervalSGIProc) fgPlatformGetProcAddress( "glXSwapIntervalSGI" );
+        if( swapIntervalSGI )
+            return swapIntervalSGI( interval ) == 0;
+    }
+
+    return GL_FALSE;
+}
+
@@ -32,6 +32,11 @@
 #include "fg_internal.h"
 #include "fg_init.h"
 #include "egl/fg_init_egl.h"
+#if defined(HAVE_SYS_EPOLL_H) && defined(HAVE_SYS_TIMERFD_H)
+#    include <sys/epoll.h>
+#    include <sys/timerfd.h>
+#    include <unistd.h>
+#endif
 
 /* Return the atom associated with "name". */
 static Atom fghGetAtom(const char * name)
@@ -166,6 +171,46 @@ int fgHintPresent(Window window, Atom property, Atom hint)
   return supported;
 }
 
+#if defined(HAVE_SYS_EPOLL_H) && defined(HAVE_SYS_TIMERFD_H)
+/*
+ * Creates the epoll set fgPlatformSleepForEvents waits on: the X connection,
+ * and a timerfd that is armed for the next timer or joystick poll so that the
+ * wait ends on time to the nanosecond. Without it, the wait uses select().
+ */
+static void fghInitializeEventWait( void )
+{
+    struct epoll_event event;
+    int eventPoll = epoll_create1( EPOLL_CLOEXEC );
+    int eventTimer = timerfd_create( CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC );
+    int ok = eventPoll >= 0 && eventTimer >= 0;
+
+    event.events = EPOLLIN;
+    if( ok )
+    {
+        event.data.fd = fgDisplay.pDisplay.Connection;
+        ok = epoll_ctl( eventPoll, EPOLL_CTL_ADD, event.data.fd, &event ) == 0;
+    }
+    if( ok )
+    {
+        event.data.fd = eventTimer;
+        ok = epoll_ctl( eventPoll, EPOLL_CTL_ADD, event.data.fd, &event ) == 0;
+    }
+
+    if( !ok )
+    {
+        fgWarning( "epoll/timerfd unavailable (error %d), waiting for events with select()", errno );
+        if( eventPoll >= 0 )
+            close( eventPoll );
+        if( eventTimer >= 0 )
+            close( eventTimer );
+        eventPoll = eventTimer = -1;
+    }
+
+    fgDisplay.pDisplay.EventPoll = eventPoll;
+    fgDisplay.pDisplay.EventTimer = eventTimer;
+}
+#endif
+
 /*
  * A call to this function should initialize all the display stuff...
  */
@@ -220,6 +265,9 @@ void fgPlatformInitialize( const char* displayName )
     );
 
     fgDisplay.pDisplay.Connection = ConnectionNumber( fgDisplay.pDisplay.Display );
+#if defined(HAVE_SYS_EPOLL_H) && defined(HAVE_SYS_TIMERFD_H)
+    fghInitializeEventWait();
+#endif
 
     /* Create the window deletion atom */
     fgDisplay.pDisplay.DeleteWindow = fghGetAtom("WM_DELETE_WINDOW");
@@ -257,7 +305,7 @@ void fgPlatformInitialize( const char* displayName )
     }
 
     /* Get start time */
-    fgState.Time = fgSystemTime();
+    fgState.Time = fgSystemTimeNs();
     
 
     fgState.Initialised = GL_TRUE;
@@ -285,6 +333,15 @@ void fgPlatformCloseDisplay ( void )
      */
     XSetCloseDownMode( fgDisplay.pDisplay.Display, DestroyAll );
 
+#if defined(HAVE_SYS_EPOLL_H) && defined(HAVE_SYS_TIMERFD_H)
+    if( fgDisplay.pDisplay.EventPoll >= 0 )
+    {
+        close( fgDisplay.pDisplay.EventPoll );
+        close( fgDisplay.pDisplay.EventTimer );
+        fgDisplay.pDisplay.EventPoll = fgDisplay.pDisplay.EventTimer = -1;
+    }
+#endif
+
     /*
      * Close the display connection, destroying all windows we have
      * created so far
@@ -90,6 +90,11 @@ struct tagSFG_PlatformDisplay
 
     int             DisplayPointerX;    /* saved X location of the pointer   */
     int             DisplayPointerY;    /* saved Y location of the pointer   */
+
+#if defined(HAVE_SYS_EPOLL_H) && defined(HAVE_SYS_TIMERFD_H)
+    int             EventPoll;          /* epoll set used to wait for events */
+    int             EventTimer;         /* timerfd for the next wakeup       */
+#endif
 };
 
 
@@ -30,6 +30,12 @@
 #include "../fg_internal.h"
 #include <errno.h>
 #include <stdarg.h>
+/* clock_gettime; fg_internal.h only pulls in <sys/time.h> on most systems */
+#include <time.h>
+#if defined(HAVE_SYS_EPOLL_H) && defined(HAVE_SYS_TIMERFD_H)
+#    include <sys/epoll.h>
+#    include <sys/timerfd.h>
+#endif
 
 
 /*
@@ -59,6 +65,13 @@ extern void fgPlatformIconifyWindow( SFG_Window *window );
 extern void fgPlatformShowWindow( SFG_Window *window );
 
 /* used in the event handling code to match and discard stale mouse motion events */
+typedef struct tagSFG_MotionMatch SFG_MotionMatch;
+struct tagSFG_MotionMatch
+{
+    Window       Target;        /* window the coalesced motion is for        */
+    unsigned int State;         /* button and modifier mask it was sent with */
+    Bool         Blocked;       /* another event was queued after the run    */
+};
 static Bool match_motion(Display *dpy, XEvent *xev, XPointer arg);
 
 /*
@@ -73,25 +86,64 @@ static Bool match_motion(Display *dpy, XEvent *xev, XPointer arg);
  
  
 
-fg_time_t fgPlatformSystemTime ( void )
+fg_time_t fgPlatformSystemTimeNs ( void )
 {
 #ifdef CLOCK_MONOTONIC
     struct timespec now;
     clock_gettime(CLOCK_MONOTONIC, &now);
-    return now.tv_nsec/1000000 + now.tv_sec*1000;
+    return now.tv_nsec + (fg_time_t)now.tv_sec*1000000000;
 #elif defined(HAVE_GETTIMEOFDAY)
     struct timeval now;
     gettimeofday( &now, NULL );
-    return now.tv_usec/1000 + now.tv_sec*1000;
+    return now.tv_usec*1000 + (fg_time_t)now.tv_sec*1000000000;
 #endif
 }
 
+#if defined(HAVE_SYS_EPOLL_H) && defined(HAVE_SYS_TIMERFD_H)
+/*
+ * Waits on the epoll set for X events or the timerfd. epoll_wait itself only
+ * counts milliseconds, so a finite wait arms the timerfd instead.
+ */
+static void fghWaitForEvents( fg_time_t nsec )
+{
+    struct epoll_event events[ 2 ];
+    struct itimerspec wakeup;
+    int timeout = -1;
+    int armed = 0;
+    int err;
+
+    memset( &wakeup, 0, sizeof( wakeup ) );
+    if( nsec == 0 )
+        timeout = 0;
+    else if( nsec < FG_NO_WAKEUP )
+    {
+        wakeup.it_value.tv_sec = nsec / 1000000000;
+        wakeup.it_value.tv_nsec = nsec % 1000000000;
+        armed = timerfd_settime( fgDisplay.pDisplay.EventTimer, 0, &wakeup, NULL ) == 0;
+        if( !armed )
+            timeout = (int)( nsec / 1000000 );
+    }
+
+    err = epoll_wait( fgDisplay.pDisplay.EventPoll, events, 2, timeout );
+
+    if( ( -1 == err ) && ( errno != EINTR ) )
+        fgWarning ( "freeglut epoll_wait() error: %d", errno );
+
+    /* Disarming also clears an expiry, so the timerfd doesn't stay readable */
+    if( armed )
+    {
+        memset( &wakeup, 0, sizeof( wakeup ) );
+        timerfd_settime( fgDisplay.pDisplay.EventTimer, 0, &wakeup, NULL );
+    }
+}
+#endif
+
 /*
  * Does the magic required to relinquish the CPU until something interesting
  * happens.
  */
 
-void fgPlatformSleepForEvents( fg_time_t msec )
+void fgPlatformSleepForEvents( fg_time_t nsec )
 {
     /*
      * Possibly due to aggressive use of XFlush() and friends,
@@ -109,11 +161,19 @@ void fgPlatformSleepForEvents( fg_time_t msec )
         int socket;
         struct timeval wait;
 
+#if defined(HAVE_SYS_EPOLL_H) && defined(HAVE_SYS_TIMERFD_H)
+        if( fgDisplay.pDisplay.EventPoll >= 0 )
+        {
+            fghWaitForEvents( nsec );
+            return;
+        }
+#endif
+
         socket = ConnectionNumber( fgDisplay.pDisplay.Display );
         FD_ZERO( &fdset );
         FD_SET( socket, &fdset );
-        wait.tv_sec = msec / 1000;
-        wait.tv_usec = (msec % 1000) * 1000;
+        wait.tv_sec = nsec / 1000000000;
+        wait.tv_usec = (nsec % 1000000000) / 1000;
         err = select( socket+1, &fdset, NULL, NULL, &wait );
 
         if( ( -1 == err ) && ( errno != EINTR ) )
@@ -122,6 +182,56 @@ void fgPlatformSleepForEvents( fg_time_t msec )
 }
 
 
+/*
+ * Returns when an event happened on the glutGetElapsedTimeNs clock.
+ *
+ * Input events carry the X server's millisecond timestamp, which runs on
+ * the server's clock. It is mapped onto ours with the smallest difference
+ * seen between receiving an event and its timestamp, i.e. that of the event
+ * that reached us fastest. If the difference grows by more than a second,
+ * the server clock has jumped or wrapped, and the mapping starts over.
+ * Events without a timestamp happened "now".
+ */
+static fg_time_t fghEventTime( XEvent *event )
+{
+    static fg_time_t serverTimeOffset;
+    static int serverTimeKnown = 0;
+    fg_time_t now = fgElapsedTimeNs( );
+    fg_time_t serverTime, offset;
+
+    switch( event->type )
+    {
+    case KeyPress:
+    case KeyRelease:
+        serverTime = event->xkey.time;
+        break;
+    case ButtonPress:
+    case ButtonRelease:
+        serverTime = event->xbutton.time;
+        break;
+    case MotionNotify:
+        serverTime = event->xmotion.time;
+        break;
+    case EnterNotify:
+    case LeaveNotify:
+        serverTime = event->xcrossing.time;
+        break;
+    default:
+        return now;
+    }
+
+    /* Unsigned arithmetic, the offset may well be "negative" */
+    serverTime *= 1000000;
+    offset = now - serverTime;
+    if( !serverTimeKnown || offset - serverTimeOffset > 1000000000 )
+    {
+        serverTimeOffset = offset;
+        serverTimeKnown = 1;
+    }
+
+    return serverTime + serverTimeOffset;
+}
+
 /*
  * Returns GLUT modifier mask for the state field of an X11 event.
  */
@@ -603,6 +713,7 @@ void fgPlatformProcessSingleEvent ( void )
 #ifdef EVENT_DEBUG
         fghPrintEvent( &event );
 #endif
+        fgState.EventTime = fghEventTime( &event );
 
         switch( event.type )
         {
@@ -761,11 +872,18 @@ void fgPlatformProcessSingleEvent ( void )
 
         case MotionNotify:
         {
-            /* if GLUT_SKIP_STALE_MOTION_EVENTS is true, then discard all but
-             * the last motion event from the queue
+            /* if GLUT_SKIP_STALE_MOTION_EVENTS is true, then collapse the run
+             * of motion events at the head of the queue into its last one.
+             * The run ends at any other event, so presses, releases and
+             * crossings are still seen at the position they happened.
              */
             if(fgState.SkipStaleMotion) {
-                while(XCheckIfEvent(fgDisplay.pDisplay.Display, &event, match_motion, 0));
+                SFG_MotionMatch match;
+                match.Target = event.xmotion.window;
+                match.State = event.xmotion.state;
+                match.Blocked = False;
+                while(XCheckIfEvent(fgDisplay.pDisplay.Display, &event, match_motion, (XPointer)&match));
+                fgState.EventTime = fghEventTime( &event );
             }
 
             GETWINDOW( xmotion );
@@ -1058,7 +1176,21 @@ void fgPlatformProcessSingleEvent ( void )
 
 static Bool match_motion(Display *dpy, XEvent *xev, XPointer arg)
 {
-    return xev->type == MotionNotify;
+    SFG_MotionMatch *match = (SFG_MotionMatch *)arg;
+
+    /* XCheckIfEvent() offers the queue front to back, so once anything
+     * else has been offered every later motion event stays queued
+     */
+    if( match->Blocked )
+        return False;
+
+    if( xev->type == MotionNotify &&
+        xev->xmotion.window == match->Target &&
+        xev->xmotion.state == match->State )
+        return True;
+
+    match->Blocked = True;
+    return False;
 }
 
 void fgPlatformMainLoopPreliminaryWork ( void )
@@ -0,0 +1,193 @@
+// Checks GamepadInput against a virtual pad made with uinput: creates the device,
+// opens it like the game does, sends stick reports and button presses and compares
+// the AXIS events that come out. Needs write access to /dev/uinput (root, or the
+// uinput group) and udev to create the /dev/input node.
+//
+//   ./Build/GamepadInput-Check
+//
+// Exits with 0 when every check passes, 1 when one fails and 77 when no virtual
+// device can be made, the code test runners such as automake's read as skipped.
+#include "GamepadInput.h"
+#include <GL/freeglut.h>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <linux/uinput.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+namespace {
+	const int SKIPPED = 77;
+	const unsigned long long WAIT_NS = 1000000000ULL; // For an event that should arrive
+	const unsigned long long QUIET_NS = 50000000ULL; // For one that shouldn't
+
+	int failures = 0;
+
+	void check(bool passed, const char* what) {
+		std::printf("%s: %s\n", passed ? "ok" : "FAIL", what);
+		if (!passed) failures++;
+	}
+
+	// A uinput pad with a single stick axis and one button
+	class VirtualPad {
+	public:
+		VirtualPad() : fd(-1) {}
+		~VirtualPad() { destroy(); }
+
+		bool create(const char* name, int minimum, int maximum, int flat) {
+			fd = open("/dev/uinput", O_WRONLY | O_NONBLOCK | O_CLOEXEC);
+			if (fd < 0) return false;
+			struct uinput_setup setup;
+			struct uinput_abs_setup axis;
+			std::memset(&setup, 0, sizeof(setup));
+			std::memset(&axis, 0, sizeof(axis));
+			setup.id.bustype = BUS_VIRTUAL;
+			setup.id.vendor = 0x1234;
+			setup.id.product = 0x5678;
+			std::snprintf(setup.name, sizeof(setup.name), "%s", name);
+			axis.code = ABS_X;
+			axis.absinfo.minimum = minimum;
+			axis.absinfo.maximum = maximum;
+			axis.absinfo.flat = flat;
+			axis.absinfo.value = (minimum + maximum) / 2;
+			char sysName[64] = "";
+			if (ioctl(fd, UI_SET_EVBIT, EV_KEY) < 0 || ioctl(fd, UI_SET_KEYBIT, BTN_GAMEPAD) < 0 ||
+				ioctl(fd, UI_SET_EVBIT, EV_ABS) < 0 || ioctl(fd, UI_SET_ABSBIT, ABS_X) < 0 ||
+				ioctl(fd, UI_ABS_SETUP, &axis) < 0 || ioctl(fd, UI_DEV_SETUP, &setup) < 0 ||
+				ioctl(fd, UI_DEV_CREATE) < 0 || ioctl(fd, UI_GET_SYSNAME(sizeof(sysName)), sysName) < 0) {
+				destroy();
+				return false;
+			}
+			// The event node is listed next to the device in sysfs
+			std::string sysPath = std::string("/sys/devices/virtual/input/") + sysName;
+			DIR* dir = opendir(sysPath.c_str());
+			if (dir) {
+				while (struct dirent* entry = readdir(dir)) {
+					if (std::strncmp(entry->d_name, "event", 5) == 0) {
+						devicePath = std::string("/dev/input/") + entry->d_name;
+					}
+				}
+				closedir(dir);
+			}
+			return !devicePath.empty();
+		}
+
+		void destroy() {
+			if (fd < 0) return;
+			ioctl(fd, UI_DEV_DESTROY);
+			close(fd);
+			fd = -1;
+		}
+
+		// One report: the events, then SYN_REPORT
+		bool send(int type, int code, int value) {
+			return write(type, code, value) && write(EV_SYN, SYN_REPORT, 0);
+		}
+		bool write(int type, int code, int value) {
+			struct input_event event;
+			std::memset(&event, 0, sizeof(event));
+			event.type = type;
+			event.code = code;
+			event.value = value;
+			return ::write(fd, &event, sizeof(event)) == sizeof(event);
+		}
+
+		const char* path() const { return devicePath.c_str(); }
+
+	private:
+		int fd;
+		std::string devicePath;
+	};
+
+	bool waitForAxis(LatestInput& position, InputEvent& event, unsigned long long timeoutNs) {
+		unsigned long long deadline = glutGetElapsedTimeNs() + timeoutNs;
+		while (!position.take(event)) {
+			if (glutGetElapsedTimeNs() > deadline) return false;
+			usleep(1000);
+		}
+		return true;
+	}
+
+	// udev creates the node a moment after the device
+	bool openPad(GamepadInput& gamepad, const VirtualPad& pad) {
+		unsigned long long deadline = glutGetElapsedTimeNs() + WAIT_NS;
+		while (!gamepad.open(pad.path())) {
+			if (glutGetElapsedTimeNs() > deadline) return false;
+			usleep(10000);
+		}
+		return true;
+	}
+
+	// Sends one stick position and checks the value and time of the AXIS event it becomes
+	void checkReport(VirtualPad& pad, LatestInput& position, int value, float expected, const char* what) {
+		unsigned long long sent = glutGetElapsedTimeNs();
+		InputEvent event;
+		bool received = pad.send(EV_ABS, ABS_X, value) && waitForAxis(position, event, WAIT_NS);
+		unsigned long long taken = glutGetElapsedTimeNs();
+		check(received && event.type == InputEvent::AXIS && std::fabs(event.value - expected) < 0.001f, what);
+		// Stamped by the kernel between the write and the read, on the game's clock
+		if (received) check(event.time + 1000000ULL >= sent && event.time <= taken, "the event time is when it was sent");
+	}
+}
+
+int main(int argc, char** argv) {
+	glutInitHeadless(&argc, argv);
+	Logger logger;
+	logger.open("/dev/stderr");
+	LatestInput position;
+	InputEvent event;
+
+	VirtualPad pad;
+	if (!pad.create("GamepadInput-Check pad", -100, 100, 10)) {
+		std::printf("skipped: can't create a uinput device (%s)\n", std::strerror(errno));
+		return SKIPPED;
+	}
+	GamepadInput gamepad(position, logger);
+	if (!openPad(gamepad, pad)) {
+		std::printf("skipped: can't open %s\n", pad.path());
+		return SKIPPED;
+	}
+	check(std::strcmp(gamepad.deviceName(), "GamepadInput-Check pad") == 0, "the device name is read");
+	check(waitForAxis(position, event, 0) && event.value == 0.0f, "opening publishes the resting position");
+
+	checkReport(pad, position, 55, 0.5f, "halfway between the dead zone and the edge reads 0.5");
+	checkReport(pad, position, 100, 1.0f, "the right edge reads 1");
+	checkReport(pad, position, 5, 0.0f, "inside the dead zone reads 0");
+	checkReport(pad, position, -55, -0.5f, "halfway to the left reads -0.5");
+	checkReport(pad, position, -100, -1.0f, "the left edge reads -1");
+
+	// A report with only a button in it doesn't move the stick
+	check(pad.send(EV_KEY, BTN_GAMEPAD, 1) && !waitForAxis(position, event, QUIET_NS), "a button press sends no axis event");
+	check(pad.write(EV_KEY, BTN_GAMEPAD, 0) && pad.send(EV_ABS, ABS_X, 100) &&
+		waitForAxis(position, event, WAIT_NS) && event.value == 1.0f, "a button and the stick in one report send the stick");
+
+	// Unplugging lets go of the paddle
+	pad.destroy();
+	check(waitForAxis(position, event, WAIT_NS) && event.value == 0.0f, "unplugging releases the stick");
+	unsigned long long deadline = glutGetElapsedTimeNs() + WAIT_NS;
+	while (gamepad.isOpen() && glutGetElapsedTimeNs() < deadline) usleep(1000);
+	check(!gamepad.isOpen(), "an unplugged pad is no longer open");
+	gamepad.close();
+
+	// A dead zone wider than half the range still leaves the edges reachable
+	VirtualPad widePad;
+	if (widePad.create("GamepadInput-Check wide dead zone", -10, 10, 15) && openPad(gamepad, widePad)) {
+		check(waitForAxis(position, event, 0) && event.value == 0.0f, "the centre of a wide dead zone reads 0");
+		checkReport(widePad, position, 10, 1.0f, "a wide dead zone's right edge reads 1");
+		checkReport(widePad, position, -10, -1.0f, "a wide dead zone's left edge reads -1");
+		checkReport(widePad, position, 9, 0.0f, "just inside a wide dead zone reads 0");
+	} else {
+		check(false, "a pad with a wide dead zone opens");
+	}
+	gamepad.close();
+	widePad.destroy();
+
+	logger.close();
+	std::printf("%d check%s failed\n", failures, failures == 1 ? "" : "s");
+	return failures ? 1 : 0;
+}